@@ -0,0 +1,271 @@
+/**
+ * @file alias.c
+ * @brief Implementación de la agrupación de dispositivos que son rutas al mismo disco
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/sysmacros.h>
+#include "alias.h"
+#include "gpt.h"
+#include "disk.h"
+
+/**
+* @brief Identity of a disk, obtained without reading it
+*/
+typedef struct {
+	int found; /*!< 1 if stat succeeded */
+	int block; /*!< 1 for block devices */
+	dev_t dev; /*!< Device that contains the file */
+	ino_t ino; /*!< Inode of the file */
+	dev_t rdev; /*!< Device number of a block device */
+	int multipath; /*!< 1 for a device-mapper multipath device */
+	char wwid[ALIAS_WWID_LEN]; /*!< WWID, empty if unknown */
+} disk_identity;
+
+/**
+* @brief Reads the first line of a sysfs attribute
+* @return 1 if the attribute was read and is not empty, 0 otherwise
+*/
+static int read_sysfs(const char * path, char * buf, int size) {
+	FILE * fd = fopen(path, "r");
+	if (fd == NULL) return 0;
+	if (fgets(buf, size, fd) == NULL) buf[0] = 0;
+	fclose(fd);
+	buf[strcspn(buf, "\r\n")] = 0;
+	return buf[0] != 0;
+}
+
+/**
+* @brief Gets the identity of a disk from stat and sysfs
+*/
+static void get_identity(char * disk, disk_identity * id) {
+	struct stat st;
+	char path[512], uuid[ALIAS_WWID_LEN];
+	memset(id, 0, sizeof(disk_identity));
+	if (stat(disk, &st) != 0) return;
+	id->found = 1;
+	id->dev = st.st_dev;
+	id->ino = st.st_ino;
+	if (!S_ISBLK(st.st_mode)) return;
+	id->block = 1;
+	id->rdev = st.st_rdev;
+	//1. WWID de discos SCSI o de espacios de nombres NVMe
+	snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/device/wwid", major(st.st_rdev), minor(st.st_rdev));
+	if (!read_sysfs(path, id->wwid, ALIAS_WWID_LEN)) {
+		snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/wwid", major(st.st_rdev), minor(st.st_rdev));
+		read_sysfs(path, id->wwid, ALIAS_WWID_LEN);
+	}
+	//2. Los dispositivos multipath de device-mapper tienen un UUID "mpath-<wwid>"
+	snprintf(path, sizeof(path), "/sys/dev/block/%u:%u/dm/uuid", major(st.st_rdev), minor(st.st_rdev));
+	if (read_sysfs(path, uuid, sizeof(uuid)) && strncmp(uuid, "mpath-", 6) == 0) {
+		id->multipath = 1;
+	}
+}
+
+/**
+* @brief Checks if a block device is a slave of a multipath device (listed in its slaves directory)
+*/
+static int is_multipath_slave(disk_identity * mpath, disk_identity * path) {
+	char dir_path[512], dev_path[512], buf[32];
+	struct dirent * entry;
+	int found = 0;
+	snprintf(dir_path, sizeof(dir_path), "/sys/dev/block/%u:%u/slaves", major(mpath->rdev), minor(mpath->rdev));
+	DIR * dir = opendir(dir_path);
+	if (dir == NULL) return 0;
+	while (!found && (entry = readdir(dir)) != NULL) {
+		unsigned int maj, min;
+		if (entry->d_name[0] == '.') continue;
+		snprintf(dev_path, sizeof(dev_path), "/sys/class/block/%s/dev", entry->d_name);
+		if (read_sysfs(dev_path, buf, sizeof(buf)) && sscanf(buf, "%u:%u", &maj, &min) == 2) {
+			found = makedev(maj, min) == path->rdev;
+		}
+	}
+	closedir(dir);
+	return found;
+}
+
+/**
+* @brief Checks if two disks are paths to the same physical disk, without reading them
+*/
+static int same_identity(disk_identity * a, disk_identity * b) {
+	if (!a->found || !b->found) return 0;
+	if (!a->block || !b->block) {
+		return !a->block && !b->block && a->dev == b->dev && a->ino == b->ino;
+	}
+	if (a->rdev == b->rdev) return 1;
+	if (a->wwid[0] && strcmp(a->wwid, b->wwid) == 0) return 1;
+	if (a->multipath && is_multipath_slave(a, b)) return 1;
+	if (b->multipath && is_multipath_slave(b, a)) return 1;
+	return 0;
+}
+
+/**
+* @brief Finds the root of a disk in the union-find forest
+*/
+static int find_root(int * parent, int i) {
+	while (parent[i] != i) {
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+/**
+* @brief Joins the sets of two disks, keeping the first disk in command line order as root
+*/
+static void join(int * parent, int a, int b) {
+	a = find_root(parent, a);
+	b = find_root(parent, b);
+	if (a < b) parent[b] = a;
+	else if (b < a) parent[a] = b;
+}
+
+/**
+* @brief Reads the disk GUID and size of a GPT disk
+* @return 1 if the disk has a valid GPT header, 0 otherwise
+*/
+static int read_disk_guid(char * disk, guid * disk_guid, unsigned long long * size) {
+	mbr boot_record;
+	gpt_header hdr;
+	if (read_lba_sector(disk, 0, (char *)&boot_record) == 0 || is_mbr(&boot_record)) return 0;
+	if (read_lba_sector(disk, 1, (char *)&hdr) == 0 || !is_valid_gpt_header(&hdr)) return 0;
+	memcpy(disk_guid, &hdr.disk_guid, sizeof(guid));
+	*size = disk_size_sectors(disk);
+	return 1;
+}
+
+/**
+* @brief Joins in a union-find forest the disks that are paths to the same physical disk
+* @param parent Parent of each disk (output); the root of each set is its first disk in command line order
+* @return 1 on success, 0 if out of memory
+*/
+static int join_aliases(char ** disks, int n, int * parent) {
+	disk_identity * ids = (disk_identity *)calloc(n, sizeof(disk_identity));
+	int * has_guid = (int *)calloc(n, sizeof(int));
+	guid * guids = (guid *)calloc(n, sizeof(guid));
+	unsigned long long * sizes = (unsigned long long *)calloc(n, sizeof(unsigned long long));
+	int ok = ids != NULL && has_guid != NULL && guids != NULL && sizes != NULL;
+
+	//1. Agrupar por las relaciones de sysfs, sin leer los discos
+	for (int i = 0; i < n && ok; i++) {
+		get_identity(disks[i], &ids[i]);
+		parent[i] = i;
+		for (int j = 0; j < i; j++) {
+			if (same_identity(&ids[j], &ids[i])) join(parent, j, i);
+		}
+	}
+
+	//2. Los dispositivos de bloque sin WWID se agrupan por el GUID del disco GPT (un sector por grupo)
+	for (int i = 0; i < n && ok; i++) {
+		if (find_root(parent, i) != i || !ids[i].block) continue;
+		int wwid = 0;
+		for (int j = i; j < n; j++) {
+			if (find_root(parent, j) == i && (ids[j].wwid[0] || ids[j].multipath)) wwid = 1;
+		}
+		if (wwid) continue;
+		has_guid[i] = read_disk_guid(disks[i], &guids[i], &sizes[i]);
+		for (int j = 0; j < i && has_guid[i]; j++) {
+			if (has_guid[j] && sizes[j] == sizes[i] && memcmp(&guids[j], &guids[i], sizeof(guid)) == 0) {
+				join(parent, j, i);
+				break;
+			}
+		}
+	}
+	free(ids);
+	free(has_guid);
+	free(guids);
+	free(sizes);
+	return ok;
+}
+
+int group_disk_aliases(char ** disks, int n, disk_group ** groups) {
+	int * parent = (int *)malloc(n * sizeof(int));
+	int * group_of = (int *)malloc(n * sizeof(int));
+	int count = 0;
+
+	*groups = (disk_group *)calloc(n, sizeof(disk_group));
+	if (parent == NULL || group_of == NULL || *groups == NULL || !join_aliases(disks, n, parent)) {
+		free(*groups);
+		*groups = NULL;
+		free(parent);
+		free(group_of);
+		return -1;
+	}
+
+	//Construir los grupos en el orden de la línea de comandos
+	for (int i = 0; i < n; i++) {
+		int root = find_root(parent, i);
+		if (root == i) {
+			group_of[i] = count;
+			(*groups)[count].disks = (char **)malloc(n * sizeof(char *));
+			if ((*groups)[count++].disks == NULL) {
+				free_disk_groups(*groups, count);
+				*groups = NULL;
+				count = -1;
+				break;
+			}
+		}
+		disk_group * group = &(*groups)[group_of[root]];
+		group->disks[group->count++] = disks[i];
+	}
+	free(parent);
+	free(group_of);
+	return count;
+}
+
+int alias_sources(char ** disks, int n, int ** source) {
+	*source = (int *)malloc((n > 0 ? n : 1) * sizeof(int));
+	if (*source == NULL || !join_aliases(disks, n, *source)) {
+		free(*source);
+		*source = NULL;
+		return 0;
+	}
+	//La raíz de cada conjunto es su primer alias, que es el que se lee
+	for (int i = 0; i < n; i++) {
+		(*source)[i] = find_root(*source, i);
+	}
+	return 1;
+}
+
+int single_disk_groups(char ** disks, int n, disk_group ** groups) {
+	*groups = (disk_group *)calloc(n, sizeof(disk_group));
+	if (*groups == NULL) {
+		return -1;
+	}
+	for (int i = 0; i < n; i++) {
+		(*groups)[i].disks = (char **)malloc(sizeof(char *));
+		if ((*groups)[i].disks == NULL) {
+			free_disk_groups(*groups, i);
+			*groups = NULL;
+			return -1;
+		}
+		(*groups)[i].disks[0] = disks[i];
+		(*groups)[i].count = 1;
+	}
+	return n;
+}
+
+void free_disk_groups(disk_group * groups, int n) {
+	for (int i = 0; i < n; i++) {
+		free(groups[i].disks);
+	}
+	free(groups);
+}
+
+void print_disk_aliases(disk_group * group) {
+	if (group->count < 2) return;
+	printf("\nAliases:");
+	for (int i = 0; i < group->count; i++) {
+		printf(" %s", group->disks[i]);
+	}
+	printf("\n");
+}
@@ -0,0 +1,73 @@
+/**
+ * @file alias.h
+ * @brief Agrupación de los dispositivos que son rutas al mismo disco (multipath)
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef ALIAS_H
+#define ALIAS_H
+
+/** @brief Maximum length of a WWID read from sysfs */
+#define ALIAS_WWID_LEN 256
+
+/**
+* @brief Disks that are aliases of the same physical disk (LUN)
+*/
+typedef struct {
+	char ** disks; /*!< Aliases, in command line order; only disks[0] is read */
+	int count; /*!< Number of aliases */
+} disk_group;
+
+/**
+* @brief Groups the disks that are paths to the same physical disk
+*
+* Before any I/O, disks are grouped by their sysfs relations: the same file,
+* a device-mapper multipath device and its slaves, and the same WWID. Then
+* the GPT header of each block device without a WWID is read, and disks with
+* the same disk GUID and size are grouped too.
+* @param disks Disk filenames
+* @param n Number of disks
+* @param groups Groups (output, release with free_disk_groups)
+* @return Number of groups, -1 if out of memory
+*/
+int group_disk_aliases(char ** disks, int n, disk_group ** groups);
+
+/**
+* @brief Puts each disk in its own group (no deduplication)
+* @param disks Disk filenames
+* @param n Number of disks
+* @param groups Groups (output, release with free_disk_groups)
+* @return Number of groups, -1 if out of memory
+*/
+int single_disk_groups(char ** disks, int n, disk_group ** groups);
+
+/**
+* @brief Finds, for each disk, the alias that is read in its place
+*
+* Disks are grouped as in group_disk_aliases; the first alias of each group
+* in command line order is read once, and its result is reported for every
+* alias of the group.
+* @param disks Disk filenames
+* @param n Number of disks
+* @param source Index of the disk read for each disk (output, release with free)
+* @return 1 on success, 0 if out of memory
+*/
+int alias_sources(char ** disks, int n, int ** source);
+
+/**
+* @brief Releases the groups built by group_disk_aliases
+* @param groups Groups
+* @param n Number of groups
+*/
+void free_disk_groups(disk_group * groups, int n);
+
+/**
+* @brief Prints the aliases of a group, if it has more than one disk
+* @param group Group
+*/
+void print_disk_aliases(disk_group * group);
+
+#endif
@@ -0,0 +1,197 @@
+/**
+ * @file bench.c
+ * @brief Implementaciones de la medición de rendimiento de lectura
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include "bench.h"
+#include "extent.h"
+#include "disk.h"
+
+/**
+* @brief Shared state of the benchmark threads
+*/
+typedef struct {
+	int fd; /*!< Open disk */
+	int random; /*!< 1 for random reads, 0 for sequential reads */
+	unsigned long long offset; /*!< First byte of the partition */
+	unsigned long long blocks; /*!< Blocks of the partition that can be read */
+	unsigned int block; /*!< Block size */
+	unsigned long long ops; /*!< Reads to make */
+	unsigned long long next; /*!< Next read */
+	double * latencies; /*!< Latency of each read in microseconds */
+	int failed; /*!< 1 if a read failed */
+} bench_job;
+
+/**
+* @brief Current monotonic time in microseconds
+*/
+static double now_us() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/**
+* @brief Benchmark thread: makes the next pending read until there are none left
+*/
+static void * bench_worker(void * arg) {
+	bench_job * job = (bench_job *)arg;
+	unsigned long long i;
+	unsigned int seed = (unsigned int)(size_t)&i ^ (unsigned int)now_us();
+	void * buf;
+	if (posix_memalign(&buf, BENCH_ALIGN, job->block) != 0) {
+		__atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	//Los hilos se detienen en cuanto alguno falla: failed se lee y escribe de forma atómica
+	while (!__atomic_load_n(&job->failed, __ATOMIC_RELAXED) && (i = __sync_fetch_and_add(&job->next, 1)) < job->ops) {
+		unsigned long long block = i % job->blocks;
+		if (job->random) {
+			block = (((unsigned long long)rand_r(&seed) << 31) ^ rand_r(&seed)) % job->blocks;
+		}
+		double start = now_us();
+		if (pread(job->fd, buf, job->block, job->offset + block * job->block) != (ssize_t)job->block) {
+			__atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+			break;
+		}
+		job->latencies[i] = now_us() - start;
+	}
+	free(buf);
+	return NULL;
+}
+
+static int compare_doubles(const void * a, const void * b) {
+	double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+/**
+* @brief Runs one access pattern over a partition
+* @return 1 on success, 0 on failure
+*/
+static int bench_pattern(int fd, unsigned long long start, unsigned long long end, int random,
+		unsigned int block, bench_options * options, bench_result * result) {
+	bench_job job;
+	pthread_t * ids;
+	int threads = options->queue_depth;
+	int started = 0;
+	unsigned long long size = (end - start + 1) * SECTOR_SIZE;
+
+	memset(&job, 0, sizeof(job));
+	memset(result, 0, sizeof(bench_result));
+	job.fd = fd;
+	job.random = random;
+	//Las lecturas empiezan en el primer bloque alineado de la partición
+	job.offset = ((start * SECTOR_SIZE + BENCH_ALIGN - 1) / BENCH_ALIGN) * BENCH_ALIGN;
+	if (job.offset - start * SECTOR_SIZE + block > size) return 1;
+	job.blocks = (size - (job.offset - start * SECTOR_SIZE)) / block;
+	job.block = block;
+	job.ops = (unsigned long long)(size * options->sample) / block;
+	if (job.ops < BENCH_MIN_OPS) job.ops = BENCH_MIN_OPS;
+	if (!random && job.ops > job.blocks) job.ops = job.blocks;
+	job.latencies = (double *)malloc(job.ops * sizeof(double));
+	if (job.latencies == NULL) return 0;
+
+	if (threads <= 0) threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if ((unsigned long long)threads > job.ops) threads = job.ops;
+	ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+	double t0 = now_us();
+	if (ids != NULL) {
+		for (; started < threads; started++) {
+			if (pthread_create(&ids[started], NULL, bench_worker, &job) != 0) break;
+		}
+	}
+	if (started == 0) bench_worker(&job);
+	for (int i = 0; i < started; i++) {
+		pthread_join(ids[i], NULL);
+	}
+	double elapsed = (now_us() - t0) / 1e6;
+	free(ids);
+	if (!job.failed) {
+		qsort(job.latencies, job.ops, sizeof(double), compare_doubles);
+		result->ops = job.ops;
+		result->seconds = elapsed;
+		result->mb_per_s = (elapsed > 0) ? job.ops * (double)block / elapsed / 1e6 : 0;
+		result->p50_us = job.latencies[job.ops / 2];
+		result->p99_us = job.latencies[(job.ops * 99) / 100];
+		result->max_us = job.latencies[job.ops - 1];
+	}
+	free(job.latencies);
+	return !job.failed;
+}
+
+/**
+* @brief Parses a size with an optional K or M suffix
+*/
+static unsigned int parse_size(char * str, char ** end) {
+	unsigned long value = strtoul(str, end, 0);
+	if (toupper((unsigned char)**end) == 'K') {
+		value *= 1024;
+		(*end)++;
+	} else if (toupper((unsigned char)**end) == 'M') {
+		value *= 1024 * 1024;
+		(*end)++;
+	}
+	return value;
+}
+
+int parse_bench_blocks(char * str, bench_options * options) {
+	char * end;
+	options->seq_block = parse_size(str, &end);
+	if (*end == ',') {
+		options->rand_block = parse_size(end + 1, &end);
+	}
+	return *end == 0 && options->seq_block > 0 && options->rand_block > 0 &&
+		options->seq_block % BENCH_ALIGN == 0 && options->rand_block % BENCH_ALIGN == 0;
+}
+
+int bench_partitions(char * disk, bench_options * options) {
+	extent_index index;
+	bench_result seq, rnd;
+	int status = EXIT_SUCCESS;
+
+	if (!build_extent_index(disk, &index)) {
+		fprintf(stderr, "Unable to read partition table of %s\n", disk);
+		return EXIT_FAILURE;
+	}
+	//O_DIRECT evita medir la caché de páginas; algunos sistemas de archivos no lo soportan
+	int fd = open(disk, O_RDONLY | O_DIRECT);
+	if (fd < 0) {
+		fd = open(disk, O_RDONLY);
+		if (fd < 0) {
+			fprintf(stderr, "Unable to open %s\n", disk);
+			free_extent_index(&index);
+			return EXIT_FAILURE;
+		}
+		fprintf(stderr, "%s: O_DIRECT not supported, results include the page cache\n", disk);
+	}
+	printf("#\tStart LBA\tEnd LBA\t\tSeq MB/s\tp50 us\tp99 us\t\tRand MB/s\tIOPS\tp50 us\tp99 us\n");
+	for (unsigned int i = 0; i < index.count; i++) {
+		if (!bench_pattern(fd, index.starts[i], index.ends[i], 0, options->seq_block, options, &seq) ||
+				!bench_pattern(fd, index.starts[i], index.ends[i], 1, options->rand_block, options, &rnd)) {
+			printf("%u\t%llu\t\t%llu\t\tread error\n", index.numbers[i], index.starts[i], index.ends[i]);
+			status = EXIT_FAILURE;
+			continue;
+		}
+		printf("%u\t%llu\t\t%llu\t\t%.1f\t\t%.0f\t%.0f\t\t%.1f\t\t%.0f\t%.0f\t%.0f\n", index.numbers[i],
+			index.starts[i], index.ends[i], seq.mb_per_s, seq.p50_us, seq.p99_us, rnd.mb_per_s,
+			rnd.seconds > 0 ? rnd.ops / rnd.seconds : 0, rnd.p50_us, rnd.p99_us);
+		fflush(stdout);
+	}
+	close(fd);
+	free_extent_index(&index);
+	return status;
+}
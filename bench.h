@@ -0,0 +1,66 @@
+/**
+ * @file bench.h
+ * @brief Medición del rendimiento de lectura de cada partición
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+/** @brief Default block size of sequential reads */
+#define BENCH_SEQ_BLOCK (1024 * 1024)
+
+/** @brief Default block size of random reads */
+#define BENCH_RAND_BLOCK 4096
+
+/** @brief Default fraction of each partition that is read */
+#define BENCH_SAMPLE 0.01
+
+/** @brief Minimum number of reads of each pattern */
+#define BENCH_MIN_OPS 64
+
+/** @brief Alignment of the buffers and offsets (required by O_DIRECT) */
+#define BENCH_ALIGN 4096
+
+/**
+* @brief Benchmark parameters
+*/
+typedef struct {
+	unsigned int seq_block; /*!< Block size of sequential reads, in bytes */
+	unsigned int rand_block; /*!< Block size of random reads, in bytes */
+	double sample; /*!< Fraction of each partition that is read (0-1] */
+	int queue_depth; /*!< Reads in flight (threads); 0 = number of online CPUs */
+} bench_options;
+
+/**
+* @brief Results of one access pattern
+*/
+typedef struct {
+	unsigned long long ops; /*!< Reads made */
+	double seconds; /*!< Wall time */
+	double mb_per_s; /*!< Throughput in MB/s (10^6 bytes) */
+	double p50_us; /*!< Median latency in microseconds */
+	double p99_us; /*!< 99th percentile latency in microseconds */
+	double max_us; /*!< Maximum latency in microseconds */
+} bench_result;
+
+/**
+* @brief Parses the block sizes given as SEQ[,RAND] with K/M suffixes
+* @param str Block sizes
+* @param options Options to update
+* @return 1 on success, 0 if a size is not a multiple of BENCH_ALIGN
+*/
+int parse_bench_blocks(char * str, bench_options * options);
+
+/**
+* @brief Measures sequential and random reads of every partition of a disk and prints the results
+* @param disk Disk filename
+* @param options Benchmark parameters
+* @return Exit status
+*/
+int bench_partitions(char * disk, bench_options * options);
+
+#endif
@@ -0,0 +1,27 @@
+/**
+ * @file crc32.h
+ * @brief Cálculo de CRC32 (IEEE 802.3) usado por los encabezados GPT
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+
+/**
+* @brief Updates a CRC32 with the contents of a buffer
+*
+* The initial value is 0. The result of a call can be passed as crc to a
+* later call to continue the computation over consecutive buffers.
+* @param crc CRC32 computed so far (0 to start)
+* @param buf Buffer
+* @param size Buffer size
+* @return CRC32 of the data seen so far
+*/
+unsigned int crc32(unsigned int crc, const void * buf, size_t size);
+
+#endif
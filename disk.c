@@ -0,0 +1,262 @@
+/**
+ * @file disk.c
+ * @brief Implementaciones para el acceso a los sectores de un disco
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include "disk.h"
+
+void (*disk_read_begin)(char * disk) = NULL;
+void (*disk_read_end)(char * disk) = NULL;
+
+/** @brief Trace being recorded, NULL if not recording */
+static FILE * record_fd = NULL;
+
+/** @brief Contents of the trace being replayed, NULL if not replaying */
+static char * replay_buf = NULL;
+
+/** @brief Size of replay_buf */
+static size_t replay_size = 0;
+
+/** @brief 1 if a write to the trace failed; the following reads are not recorded */
+static int record_failed = 0;
+
+/**
+ * @brief Finds the next record of a disk in the trace being replayed
+ * 
+ * @param pos Position of the search, updated past the record found
+ * @return char* Data of the record (rec is filled), NULL if there are no more records of the disk
+ */
+static char * next_replay_record(char * disk, size_t * pos, trace_record * rec) {
+	size_t disk_len = strlen(disk);
+	while (*pos + sizeof(trace_record) <= replay_size) {
+		memcpy(rec, replay_buf + *pos, sizeof(trace_record));
+		char * name = replay_buf + *pos + sizeof(trace_record);
+		*pos += sizeof(trace_record) + rec->name_len + rec->length;
+		if (*pos > replay_size) break;
+		if (rec->name_len == disk_len && memcmp(name, disk, disk_len) == 0) {
+			return name + rec->name_len;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Serves a read from the trace being replayed
+ * 
+ * Any recorded read of the same disk that covers the requested range is used.
+ * @return int 1 on success, 0 if the range was not recorded
+ */
+static int replay_read(char * disk, unsigned long long offset, size_t size, char * buf) {
+	size_t pos = strlen(TRACE_MAGIC);
+	trace_record rec;
+	char * data;
+	while ((data = next_replay_record(disk, &pos, &rec)) != NULL) {
+		if (rec.length > 0 && rec.offset <= offset && offset + size <= rec.offset + rec.length) {
+			memcpy(buf, data + (offset - rec.offset), size);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Appends a record to the trace being recorded
+ * 
+ * A write error is reported once and stops the recording.
+ */
+static void record_write(char * disk, unsigned long long offset, size_t size, char * buf) {
+	trace_record rec;
+	rec.name_len = strlen(disk);
+	rec.offset = offset;
+	rec.length = size;
+	//El registro se escribe completo aunque varios hilos lean a la vez
+	flockfile(record_fd);
+	if (!record_failed && (fwrite(&rec, sizeof(rec), 1, record_fd) != 1 ||
+			fwrite(disk, 1, rec.name_len, record_fd) != rec.name_len || fwrite(buf, 1, size, record_fd) != size)) {
+		fprintf(stderr, "Unable to write the trace, recording stopped\n");
+		record_failed = 1;
+	}
+	funlockfile(record_fd);
+}
+
+/**
+ * @brief Appends a read to the trace being recorded
+ */
+static void record_read(char * disk, unsigned long long offset, size_t size, char * buf) {
+	if (size > 0) record_write(disk, offset, size, buf);
+}
+
+unsigned long long disk_size_sectors(char * disk) {
+	struct stat st;
+	unsigned long long size = 0;
+	//Con una traza cargada, el tamaño es el que se grabó (0 si no se grabó)
+	if (replay_buf != NULL) {
+		size_t pos = strlen(TRACE_MAGIC);
+		trace_record rec;
+		while (next_replay_record(disk, &pos, &rec) != NULL) {
+			if (rec.length == 0) return rec.offset / SECTOR_SIZE;
+		}
+		return 0;
+	}
+	int fd = open(disk, O_RDONLY);
+	if (fd < 0) {
+		return 0;
+	}
+	if (fstat(fd, &st) == 0) {
+		//Los dispositivos de bloque reportan su tamaño por ioctl, no por stat
+		if (S_ISBLK(st.st_mode)) {
+			if (ioctl(fd, BLKGETSIZE64, &size) != 0) size = 0;
+		} else {
+			size = st.st_size;
+		}
+	}
+	close(fd);
+	if (record_fd != NULL) {
+		record_write(disk, size, 0, NULL);
+	}
+	return size / SECTOR_SIZE;
+}
+
+unsigned int disk_block_size(int fd) {
+	struct stat st;
+	unsigned int size = 0;
+	if (fstat(fd, &st) != 0) {
+		return SECTOR_SIZE;
+	}
+	//1. Dispositivos de bloque: bloque físico, o bloque lógico si el físico no se conoce
+	if (S_ISBLK(st.st_mode)) {
+		if (ioctl(fd, BLKPBSZGET, &size) != 0 || size == 0) {
+			int logical = 0;
+			size = (ioctl(fd, BLKSSZGET, &logical) == 0 && logical > 0) ? (unsigned int)logical : SECTOR_SIZE;
+		}
+	} else {
+		//2. Archivos: bloque del sistema de archivos, hasta una página
+		size = (st.st_blksize > DISK_MAX_BLOCK_SIZE) ? DISK_MAX_BLOCK_SIZE : st.st_blksize;
+	}
+	//Solo potencias de dos múltiplos de un sector
+	if (size < SECTOR_SIZE || (size & (size - 1)) != 0) {
+		size = SECTOR_SIZE;
+	}
+	return size;
+}
+
+int disk_record(char * filename) {
+	record_fd = fopen(filename, "wb");
+	if (record_fd == NULL) {
+		return 0;
+	}
+	if (fwrite(TRACE_MAGIC, 1, strlen(TRACE_MAGIC), record_fd) != strlen(TRACE_MAGIC)) {
+		fclose(record_fd);
+		record_fd = NULL;
+		return 0;
+	}
+	record_failed = 0;
+	return 1;
+}
+
+int disk_replay(char * filename) {
+	FILE * fd = fopen(filename, "rb");
+	long size;
+	if (fd == NULL) {
+		return 0;
+	}
+	//La traza completa se carga en memoria: un escaneo lee solo unos pocos KB
+	if (fseek(fd, 0, SEEK_END) != 0 || (size = ftell(fd)) < (long)strlen(TRACE_MAGIC) || fseek(fd, 0, SEEK_SET) != 0) {
+		fclose(fd);
+		return 0;
+	}
+	replay_buf = (char *)malloc(size);
+	if (replay_buf == NULL || fread(replay_buf, 1, size, fd) != (size_t)size ||
+			memcmp(replay_buf, TRACE_MAGIC, strlen(TRACE_MAGIC)) != 0) {
+		free(replay_buf);
+		replay_buf = NULL;
+		fclose(fd);
+		return 0;
+	}
+	replay_size = size;
+	fclose(fd);
+	return 1;
+}
+
+void disk_close_trace() {
+	//Los datos pendientes se escriben al cerrar: un error aquí también deja la traza incompleta
+	if (record_fd != NULL) {
+		if (fclose(record_fd) != 0 && !record_failed) {
+			fprintf(stderr, "Unable to write the trace\n");
+		}
+		record_fd = NULL;
+	}
+	free(replay_buf);
+	replay_buf = NULL;
+	replay_size = 0;
+}
+
+int read_lba_sector(char * disk, unsigned long long lba, char buf[512]) {
+	return read_lba_sectors(disk, lba, 1, buf);
+}
+
+int disk_open(char * disk, FILE ** fd) {
+	*fd = NULL;
+	//Con una traza cargada, las lecturas no tocan el dispositivo
+	if (replay_buf != NULL) {
+		return 1;
+	}
+	//Abrir el archivo en modo lectura
+	*fd = fopen(disk, "r");
+	if (*fd == NULL) {	
+		fprintf(stderr, "No se pudo abrir el archivo %s\n", disk);
+		return 0;
+	}
+	return 1;
+}
+
+void disk_close(FILE * fd) {
+	if (fd != NULL) {
+		fclose(fd);
+	}
+}
+
+int read_open_sectors(FILE * fd, char * disk, unsigned long long lba, unsigned int count, char * buf) {
+	size_t size = (size_t)count * SECTOR_SIZE;
+	if (replay_buf != NULL) {
+		return replay_read(disk, lba * SECTOR_SIZE, size, buf);
+	}
+	//Con un planificador activo, esperar un turno del disco y de su controlador
+	if (disk_read_begin != NULL) disk_read_begin(disk);
+	//Avanzar el apuntador de lectura en el dispositivo; una lectura fallida anterior no afecta a esta
+	clearerr(fd);
+	int ok = fseek(fd, lba * SECTOR_SIZE, SEEK_SET) == 0;
+	//Leer los sectores del disco
+	if (ok) ok = fread(buf, 1, size, fd) == size;
+	if (disk_read_end != NULL) disk_read_end(disk);
+	if (!ok) {
+		return 0;
+	}
+	if (record_fd != NULL) {
+		record_read(disk, lba * SECTOR_SIZE, size, buf);
+	}
+	return 1;
+}
+
+int read_lba_sectors(char * disk, unsigned long long lba, unsigned int count, char * buf) {
+	FILE *fd;
+	if (!disk_open(disk, &fd)) {
+		return 0;
+	}
+	int ok = read_open_sectors(fd, disk, lba, count, buf);
+	//Cerrar el archivo
+	disk_close(fd);
+	return ok;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file disk.h
+ * @brief Acceso a los sectores de un dispositivo de disco
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef DISK_H
+#define DISK_H
+
+#include <stdio.h>
+
+/** @brief Sector size */
+#define SECTOR_SIZE 512
+
+/** @brief Largest block size reported for regular files */
+#define DISK_MAX_BLOCK_SIZE 4096
+
+/** @brief Magic number at the beginning of a trace file */
+#define TRACE_MAGIC "LPTRACE1"
+
+/**
+ * @brief Header of a read stored in a trace file
+ *
+ * Followed by name_len bytes with the disk filename and length bytes of data.
+ * A record with length 0 stores in offset the size of the disk in bytes, as
+ * found by disk_size_sectors().
+ */
+typedef struct {
+	unsigned short name_len; /*!< Length of the disk filename */
+	unsigned long long offset; /*!< Offset of the read in bytes */
+	unsigned int length; /*!< Length of the read in bytes */
+}__attribute__((packed)) trace_record;
+
+/**
+ * @brief Called before every device read of read_lba_sectors() (NULL by default)
+ * 
+ * Used by the scheduler of multi-device scans to wait for a free slot.
+ */
+extern void (*disk_read_begin)(char * disk);
+
+/**
+ * @brief Called after every device read of read_lba_sectors() (NULL by default)
+ */
+extern void (*disk_read_end)(char * disk);
+
+/**
+ * @brief Read a sector from a disk
+ * 
+ * @param disk Disk filename
+ * @param lba Sector to read (0 - amount of LBA sectors on disk)
+ * @param buf Buffer to read the sector info
+ * @return int 1 on success, 0 on failure
+ */
+int read_lba_sector(char * disk, unsigned long long lba, char buf[512]);
+
+/**
+ * @brief Read consecutive sectors from a disk with a single read
+ * 
+ * @param disk Disk filename
+ * @param lba First sector to read
+ * @param count Number of sectors to read
+ * @param buf Buffer of at least count * SECTOR_SIZE bytes
+ * @return int 1 on success, 0 on failure
+ */
+int read_lba_sectors(char * disk, unsigned long long lba, unsigned int count, char * buf);
+
+/**
+ * @brief Opens a disk for several reads with read_open_sectors()
+ * 
+ * When a trace is being replayed no file is opened and fd is set to NULL.
+ * @param disk Disk filename
+ * @param fd Open disk, to be closed with disk_close()
+ * @return int 1 on success, 0 on failure
+ */
+int disk_open(char * disk, FILE ** fd);
+
+/**
+ * @brief Closes a disk opened with disk_open()
+ * 
+ * @param fd Open disk (may be NULL)
+ */
+void disk_close(FILE * fd);
+
+/**
+ * @brief Read consecutive sectors from a disk opened with disk_open()
+ * 
+ * Like read_lba_sectors(), without opening the disk for every read.
+ * @param fd Open disk
+ * @param disk Disk filename
+ * @param lba First sector to read
+ * @param count Number of sectors to read
+ * @param buf Buffer of at least count * SECTOR_SIZE bytes
+ * @return int 1 on success, 0 on failure
+ */
+int read_open_sectors(FILE * fd, char * disk, unsigned long long lba, unsigned int count, char * buf);
+
+/**
+ * @brief Size of a disk or image file in sectors
+ * 
+ * When a trace is being replayed, the size recorded in it is returned.
+ * @param disk Disk filename
+ * @return unsigned long long Number of sectors, 0 if it cannot be determined
+ */
+unsigned long long disk_size_sectors(char * disk);
+
+/**
+ * @brief Physical block size of an open disk
+ * 
+ * Writes that start and end on this boundary avoid a read-modify-write in the
+ * device (512e disks) and are accepted with O_DIRECT (4Kn disks). Regular
+ * files report the block of their file system, up to DISK_MAX_BLOCK_SIZE.
+ * @param fd Open disk or image
+ * @return unsigned int Block size in bytes, a power of two and at least SECTOR_SIZE
+ */
+unsigned int disk_block_size(int fd);
+
+/**
+ * @brief Records every read made through read_lba_sectors() and every disk size in a trace file
+ * 
+ * A write error is reported on stderr and stops the recording.
+ * @param filename Trace filename (overwritten)
+ * @return int 1 on success, 0 on failure
+ */
+int disk_record(char * filename);
+
+/**
+ * @brief Serves every read made through read_lba_sectors() and every disk size from a trace file, without device access
+ * 
+ * @param filename Trace filename
+ * @return int 1 on success, 0 on failure
+ */
+int disk_replay(char * filename);
+
+/**
+ * @brief Closes the trace being recorded or replayed
+ */
+void disk_close_trace();
+
+#endif
@@ -0,0 +1,164 @@
+/**
+ * @file dump.c
+ * @brief Implementaciones del volcado hexadecimal y ASCII
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "dump.h"
+#include "disk.h"
+#include "gpt.h"
+
+/** @brief Hexadecimal digits */
+static const char hex_digits[] = "0123456789abcdef";
+
+/** @brief ASCII column character of each byte value ('.' for non-printable bytes) */
+static char ascii_table[256];
+
+/** @brief Two hexadecimal digits of each byte value */
+static char hex_table[256][2];
+
+/**
+* @brief Fills the formatting tables the first time they are used
+*/
+static void init_tables() {
+	static int ready = 0;
+	if (ready) return;
+	for (int i = 0; i < 256; i++) {
+		hex_table[i][0] = hex_digits[i >> 4];
+		hex_table[i][1] = hex_digits[i & 0x0f];
+		ascii_table[i] = (i >= 0x20 && i < 0x7F) ? i : '.';
+	}
+	ready = 1;
+}
+
+size_t format_dump(const unsigned char * buf, size_t size, unsigned long long offset, char * out) {
+	char * ptr = out;
+	init_tables();
+	for (size_t line = 0; line < size; line += DUMP_BYTES_PER_LINE) {
+		size_t n = (size - line < DUMP_BYTES_PER_LINE) ? size - line : DUMP_BYTES_PER_LINE;
+		unsigned long long value = offset + line;
+		//1. Desplazamiento en 16 dígitos hexadecimales
+		for (int i = 15; i >= 0; i--) {
+			ptr[i] = hex_digits[value & 0x0f];
+			value >>= 4;
+		}
+		ptr += 16;
+		*ptr++ = ' ';
+		*ptr++ = ' ';
+		//2. Columnas hexadecimales, rellenando con espacios la última línea
+		for (size_t i = 0; i < DUMP_BYTES_PER_LINE; i++) {
+			if (i < n) {
+				ptr[0] = hex_table[buf[line + i]][0];
+				ptr[1] = hex_table[buf[line + i]][1];
+			} else {
+				ptr[0] = ' ';
+				ptr[1] = ' ';
+			}
+			ptr[2] = ' ';
+			ptr += 3;
+		}
+		*ptr++ = ' ';
+		//3. Columna ASCII
+		for (size_t i = 0; i < n; i++) {
+			*ptr++ = ascii_table[buf[line + i]];
+		}
+		*ptr++ = '\n';
+	}
+	return ptr - out;
+}
+
+int dump_sectors(char * disk, unsigned long long lba, unsigned long long count) {
+	char * buf = (char *)malloc(DUMP_WINDOW * SECTOR_SIZE);
+	char * out = (char *)malloc((DUMP_WINDOW * SECTOR_SIZE / DUMP_BYTES_PER_LINE) * DUMP_LINE_LEN);
+	FILE * fd = NULL;
+	int status = 1;
+	if (buf == NULL || out == NULL || !disk_open(disk, &fd)) {
+		free(buf);
+		free(out);
+		return 0;
+	}
+	//Se lee y se escribe por ventanas sobre un solo descriptor: la memoria no depende del tamaño del rango
+	while (count > 0) {
+		unsigned int n = (count < DUMP_WINDOW) ? count : DUMP_WINDOW;
+		unsigned int done = n;
+		if (read_open_sectors(fd, disk, lba, n, buf) == 0) {
+			//Si la ventana cruza el final del disco, leer solo esta ventana sector por sector hasta el último legible
+			for (done = 0; done < n && read_open_sectors(fd, disk, lba + done, 1, buf + (size_t)done * SECTOR_SIZE); done++);
+		}
+		size_t len = format_dump((unsigned char *)buf, (size_t)done * SECTOR_SIZE, lba * SECTOR_SIZE, out);
+		if (fwrite(out, 1, len, stdout) != len || done < n) {
+			status = 0;
+			break;
+		}
+		lba += n;
+		count -= n;
+	}
+	disk_close(fd);
+	free(buf);
+	free(out);
+	return status;
+}
+
+int dump_range(char * disk, char * range) {
+	unsigned long long lba = 0;
+	unsigned long long count = 1;
+	gpt_header hdr;
+	char * end;
+
+	//1. Regiones GPT con nombre
+	if (strcmp(range, "mbr") == 0) {
+		lba = 0;
+	} else if (strcmp(range, "header") == 0) {
+		//El encabezado se vuelca aunque esté dañado: es lo que se quiere investigar
+		lba = 1;
+	} else if (strcmp(range, "array") == 0 || strcmp(range, "backup") == 0 || strcmp(range, "backup-array") == 0) {
+		//1.1 La copia de respaldo está en alternate_lba del primario, o en el último sector si el primario no es válido
+		unsigned long long sectors = disk_size_sectors(disk);
+		int valid = read_lba_sector(disk, 1, (char *)&hdr) != 0 && is_valid_gpt_header(&hdr);
+		lba = 1;
+		if (strncmp(range, "backup", 6) == 0) {
+			lba = (valid && hdr.alternate_lba < sectors) ? hdr.alternate_lba : sectors - 1;
+			if (!valid) {
+				fprintf(stderr, "%s: invalid GPT header, using the last sector as backup header\n", disk);
+			}
+			valid = read_lba_sector(disk, lba, (char *)&hdr) != 0 && is_valid_gpt_header(&hdr);
+		}
+		//1.2 Un arreglo se ubica con su encabezado; sin encabezado válido se usa la ubicación estándar
+		if (strstr(range, "array") != NULL) {
+			if (valid && gpt_entries_within_limits(&hdr)) {
+				lba = hdr.partition_entry_lba;
+				count = gpt_array_sectors(&hdr);
+			} else {
+				count = DUMP_DEFAULT_ARRAY_SECTORS;
+				lba = (lba == 1 || lba <= count) ? 2 : lba - count;
+				fprintf(stderr, "%s: invalid GPT header, dumping the default array location (LBA %llu)\n", disk, lba);
+			}
+		}
+	} else {
+		//2. Rango numérico LBA[:count]
+		lba = strtoull(range, &end, 0);
+		if (end == range || (*end != 0 && *end != ':')) {
+			fprintf(stderr, "Invalid range %s\n", range);
+			return EXIT_FAILURE;
+		}
+		if (*end == ':') {
+			count = strtoull(end + 1, &end, 0);
+			if (*end != 0 || count == 0) {
+				fprintf(stderr, "Invalid range %s\n", range);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	if (!dump_sectors(disk, lba, count)) {
+		fflush(stdout);
+		fprintf(stderr, "%s: unable to read sectors\n", disk);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
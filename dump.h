@@ -0,0 +1,54 @@
+/**
+ * @file dump.h
+ * @brief Volcado hexadecimal y ASCII de sectores de un disco
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef DUMP_H
+#define DUMP_H
+
+#include <stddef.h>
+
+/** @brief Bytes shown in each line of a dump */
+#define DUMP_BYTES_PER_LINE 16
+
+/** @brief Length of a dump line: offset, hex columns, ASCII column and newline */
+#define DUMP_LINE_LEN (16 + 2 + DUMP_BYTES_PER_LINE * 3 + 1 + DUMP_BYTES_PER_LINE + 1)
+
+/** @brief Sectors read and formatted at once by dump_sectors() */
+#define DUMP_WINDOW 256
+
+/** @brief Sectors of a default entry array (128 entries of 128 bytes), dumped when its header is not valid */
+#define DUMP_DEFAULT_ARRAY_SECTORS 32
+
+/**
+* @brief Formats a buffer as dump lines (offset, hex and ASCII columns)
+* @param buf Pointer to buffer
+* @param size Buffer size
+* @param offset Offset of the first byte, shown at the beginning of each line
+* @param out Output buffer of at least DUMP_LINE_LEN bytes per started line
+* @return Number of bytes written to out
+*/
+size_t format_dump(const unsigned char * buf, size_t size, unsigned long long offset, char * out);
+
+/**
+* @brief Dumps a range of sectors, reading and writing it in windows of DUMP_WINDOW sectors
+* @param disk Disk filename
+* @param lba First sector
+* @param count Number of sectors
+* @return 1 on success, 0 if a sector could not be read
+*/
+int dump_sectors(char * disk, unsigned long long lba, unsigned long long count);
+
+/**
+* @brief Dumps a range given as LBA[:count] or as a region name (mbr, header, array, backup, backup-array)
+* @param disk Disk filename
+* @param range Range to dump
+* @return Exit status
+*/
+int dump_range(char * disk, char * range);
+
+#endif
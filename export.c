@@ -0,0 +1,260 @@
+/**
+ * @file export.c
+ * @brief Implementaciones del exportador de métricas de Prometheus
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "export.h"
+#include "layout.h"
+#include "disk.h"
+#include "sched.h"
+
+/**
+* @brief Appends a partition to a scan result
+*/
+static int add_partition(export_disk * result, unsigned int number, unsigned long long start,
+		unsigned long long end, const char * type) {
+	if (result->count == result->capacity) {
+		unsigned int capacity = (result->capacity == 0) ? 8 : result->capacity * 2;
+		export_partition * ptr = (export_partition *)realloc(result->partitions, capacity * sizeof(export_partition));
+		if (ptr == NULL) return 0;
+		result->partitions = ptr;
+		result->capacity = capacity;
+	}
+	export_partition * part = &result->partitions[result->count++];
+	part->number = number;
+	strncpy(part->type, type, sizeof(part->type) - 1);
+	part->type[sizeof(part->type) - 1] = 0;
+	part->size = (end - start + 1) * SECTOR_SIZE;
+	result->allocated += end - start + 1;
+	return 1;
+}
+
+/**
+* @brief Adds a non-null GPT descriptor to a scan result (gpt_entry_callback)
+*/
+static int add_gpt_partition(gpt_partition_descriptor * desc, unsigned int index, void * arg) {
+	if (is_null_descriptor(desc)) return 1;
+	char * type = guid_to_str((guid *)desc->partition_type_guid);
+	int ok = add_partition((export_disk *)arg, index + 1, desc->starting_lba, desc->ending_lba, type);
+	free(type);
+	return ok;
+}
+
+/**
+* @brief Seconds elapsed since a start time
+*/
+static double elapsed(struct timespec * start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int scan_export_disk(char * disk, export_disk * result) {
+	mbr boot_record;
+	gpt_header hdr, backup;
+	struct timespec start;
+
+	memset(result, 0, sizeof(export_disk));
+	result->disk = disk;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (read_lba_sector(disk, 0, (char *)&boot_record) == 0) {
+		result->seconds = elapsed(&start);
+		return 0;
+	}
+	if (is_mbr(&boot_record)) {
+		//1. MBR: el espacio usable es todo el disco menos el primer sector
+		char type[8];
+		for (int i = 0; i < 4; i++) {
+			mbr_partition_descriptor * desc = &boot_record.partition_table[i];
+			if (desc->partition_type == MBR_TYPE_UNUSED || desc->sectors_in_partition == 0) continue;
+			snprintf(type, sizeof(type), "0x%02x", desc->partition_type);
+			if (!add_partition(result, i + 1, desc->starting_sector_lba,
+					(unsigned long long)desc->starting_sector_lba + desc->sectors_in_partition - 1, type)) {
+				//Sin memoria, el disco se reporta como no leído en lugar de omitir particiones
+				result->seconds = elapsed(&start);
+				return 0;
+			}
+		}
+		unsigned long long sectors = disk_size_sectors(disk);
+		result->usable = (sectors > 0) ? sectors - 1 : 0;
+		result->scheme = LAYOUT_SCHEME_MBR;
+		result->seconds = elapsed(&start);
+		return 1;
+	}
+	//2. GPT: encabezado primario, arreglo y copia de respaldo
+	if (read_lba_sector(disk, 1, (char *)&hdr) == 0 || !is_valid_gpt_header(&hdr)) {
+		result->seconds = elapsed(&start);
+		return 0;
+	}
+	result->scheme = LAYOUT_SCHEME_GPT;
+	result->header_crc_ok = gpt_header_crc_ok(&hdr);
+	result->array_crc_ok = gpt_read_entries(disk, &hdr, add_gpt_partition, result) == GPT_ENTRIES_OK;
+	if (hdr.last_usable_lba >= hdr.first_usable_lba) {
+		result->usable = hdr.last_usable_lba - hdr.first_usable_lba + 1;
+	}
+	if (read_lba_sector(disk, hdr.alternate_lba, (char *)&backup) != 0 && is_valid_gpt_header(&backup) &&
+			gpt_header_crc_ok(&backup) && backup.my_lba == hdr.alternate_lba) {
+		result->backup_ok = gpt_read_entries(disk, &backup, NULL, NULL) == GPT_ENTRIES_OK;
+	}
+	result->seconds = elapsed(&start);
+	return 1;
+}
+
+void free_export_disk(export_disk * result) {
+	free(result->partitions);
+	result->partitions = NULL;
+	result->count = 0;
+}
+
+/**
+* @brief Writes a label value escaped as required by the Prometheus text format
+*/
+static void write_label(FILE * out, const char * value) {
+	for (; *value; value++) {
+		if (*value == '\\' || *value == '"') fputc('\\', out);
+		if (*value == '\n') {
+			fputs("\\n", out);
+			continue;
+		}
+		fputc(*value, out);
+	}
+}
+
+/**
+* @brief Writes the HELP and TYPE lines of a metric family
+*/
+static void write_family(FILE * out, const char * name, const char * type, const char * help) {
+	fprintf(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+/**
+* @brief Writes a per-disk sample
+*/
+static void write_disk_sample(FILE * out, const char * name, export_disk * result, const char * fmt, double value) {
+	fprintf(out, "%s{device=\"", name);
+	write_label(out, result->disk);
+	fputs("\"} ", out);
+	fprintf(out, fmt, value);
+	fputc('\n', out);
+}
+
+/**
+* @brief Results of the disks scanned by the scheduler
+*/
+typedef struct {
+	export_disk * results; /*!< Scan result of each disk */
+	int * ok; /*!< 1 for each disk scanned successfully */
+	const int * source; /*!< Disk read for each disk, NULL to read all of them */
+} export_scan;
+
+/**
+* @brief Scans a disk for export_metrics (sched_task)
+*/
+static void export_task(char * disk, int index, void * arg) {
+	export_scan * scan = (export_scan *)arg;
+	if (scan->source != NULL && scan->source[index] != index) return;
+	scan->ok[index] = scan_export_disk(disk, &scan->results[index]);
+}
+
+/**
+* @brief Releases the scan results, skipping those shared with another alias
+*/
+static void free_export_results(export_disk * results, const int * source, int n) {
+	for (int i = 0; i < n; i++) {
+		if (source == NULL || source[i] == i) free_export_disk(&results[i]);
+	}
+	free(results);
+}
+
+int export_metrics(char * filename, char ** disks, int n, const int * source, int threads) {
+	char * text = NULL;
+	size_t len = 0;
+	FILE * out;
+	export_disk * results = (export_disk *)calloc(n, sizeof(export_disk));
+	if (results == NULL) return 0;
+
+	//1. Escanear todos los discos antes de escribir, para agrupar cada familia de métricas
+	int * ok = (int *)calloc(n, sizeof(int));
+	if (ok == NULL) {
+		free(results);
+		return 0;
+	}
+	export_scan scan = {results, ok, source};
+	sched_scan(disks, n, threads, export_task, &scan);
+	//Cada alias reporta el resultado del disco leído en su lugar, con su propio nombre
+	for (int i = 0; source != NULL && i < n; i++) {
+		if (source[i] == i) continue;
+		results[i] = results[source[i]];
+		results[i].disk = disks[i];
+		ok[i] = ok[source[i]];
+	}
+
+	//2. Generar el texto completo en memoria
+	out = open_memstream(&text, &len);
+	if (out == NULL) {
+		free_export_results(results, source, n);
+		free(ok);
+		return 0;
+	}
+	write_family(out, "listpart_scan_success", "gauge", "1 if the partition table could be read.");
+	for (int i = 0; i < n; i++) write_disk_sample(out, "listpart_scan_success", &results[i], "%.0f", ok[i]);
+	write_family(out, "listpart_scan_duration_seconds", "gauge", "Time spent reading the partition table.");
+	for (int i = 0; i < n; i++) write_disk_sample(out, "listpart_scan_duration_seconds", &results[i], "%.6f", results[i].seconds);
+	write_family(out, "listpart_partitions", "gauge", "Number of partitions.");
+	for (int i = 0; i < n; i++) if (ok[i]) write_disk_sample(out, "listpart_partitions", &results[i], "%.0f", results[i].count);
+	write_family(out, "listpart_usable_bytes", "gauge", "Bytes available for partitions.");
+	for (int i = 0; i < n; i++) if (ok[i]) write_disk_sample(out, "listpart_usable_bytes", &results[i], "%.0f", (double)results[i].usable * SECTOR_SIZE);
+	write_family(out, "listpart_free_bytes", "gauge", "Usable bytes not assigned to any partition.");
+	for (int i = 0; i < n; i++) {
+		if (!ok[i]) continue;
+		unsigned long long free_sectors = (results[i].usable > results[i].allocated) ? results[i].usable - results[i].allocated : 0;
+		write_disk_sample(out, "listpart_free_bytes", &results[i], "%.0f", (double)free_sectors * SECTOR_SIZE);
+	}
+	write_family(out, "listpart_gpt_header_crc_ok", "gauge", "1 if the primary GPT header CRC32 is valid.");
+	for (int i = 0; i < n; i++) if (results[i].scheme == LAYOUT_SCHEME_GPT) write_disk_sample(out, "listpart_gpt_header_crc_ok", &results[i], "%.0f", results[i].header_crc_ok);
+	write_family(out, "listpart_gpt_array_crc_ok", "gauge", "1 if the primary partition entry array CRC32 is valid.");
+	for (int i = 0; i < n; i++) if (results[i].scheme == LAYOUT_SCHEME_GPT) write_disk_sample(out, "listpart_gpt_array_crc_ok", &results[i], "%.0f", results[i].array_crc_ok);
+	write_family(out, "listpart_gpt_backup_ok", "gauge", "1 if the backup GPT header and entry array are valid.");
+	for (int i = 0; i < n; i++) if (results[i].scheme == LAYOUT_SCHEME_GPT) write_disk_sample(out, "listpart_gpt_backup_ok", &results[i], "%.0f", results[i].backup_ok);
+	write_family(out, "listpart_partition_size_bytes", "gauge", "Size of each partition.");
+	for (int i = 0; i < n; i++) {
+		for (unsigned int j = 0; j < results[i].count; j++) {
+			fputs("listpart_partition_size_bytes{device=\"", out);
+			write_label(out, results[i].disk);
+			fprintf(out, "\",partition=\"%u\",type=\"%s\"} %llu\n", results[i].partitions[j].number,
+				results[i].partitions[j].type, results[i].partitions[j].size);
+		}
+	}
+	fclose(out);
+	free_export_results(results, source, n);
+	free(ok);
+	if (text == NULL) return 0;
+
+	//3. Una sola escritura a un archivo temporal y reemplazo atómico con rename
+	size_t tmp_len = strlen(filename) + 16;
+	char * tmp = (char *)malloc(tmp_len);
+	int status = 0;
+	if (tmp != NULL) {
+		snprintf(tmp, tmp_len, "%s.%d.tmp", filename, (int)getpid());
+		int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd >= 0) {
+			status = write(fd, text, len) == (ssize_t)len;
+			status = (close(fd) == 0) && status;
+			if (status && rename(tmp, filename) != 0) status = 0;
+			if (!status) unlink(tmp);
+		}
+		free(tmp);
+	}
+	free(text);
+	return status;
+}
@@ -0,0 +1,68 @@
+/**
+ * @file export.h
+ * @brief Exportación de métricas de particiones en formato de texto de Prometheus
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef EXPORT_H
+#define EXPORT_H
+
+/**
+* @brief Partition reported by the exporter
+*/
+typedef struct {
+	unsigned int number; /*!< Partition number */
+	char type[37]; /*!< Type GUID, or MBR type in hexadecimal */
+	unsigned long long size; /*!< Size in bytes */
+} export_partition;
+
+/**
+* @brief Scan results of a disk
+*/
+typedef struct {
+	char * disk; /*!< Disk filename */
+	int scheme; /*!< LAYOUT_SCHEME_MBR, LAYOUT_SCHEME_GPT or 0 if the scan failed */
+	unsigned int count; /*!< Number of partitions */
+	unsigned int capacity; /*!< Capacity of partitions */
+	export_partition * partitions; /*!< Partitions */
+	unsigned long long usable; /*!< Usable sectors */
+	unsigned long long allocated; /*!< Sectors assigned to partitions */
+	int header_crc_ok; /*!< 1 if the primary GPT header CRC is valid */
+	int array_crc_ok; /*!< 1 if the primary entry array CRC is valid */
+	int backup_ok; /*!< 1 if the backup header and its entry array are valid */
+	double seconds; /*!< Scan latency */
+} export_disk;
+
+/**
+* @brief Scans a disk and collects the values exported as metrics
+* @param disk Disk filename
+* @param result Results to fill (release with free_export_disk)
+* @return 1 on success, 0 on failure
+*/
+int scan_export_disk(char * disk, export_disk * result);
+
+/**
+* @brief Releases the partitions of a scan result
+* @param result Scan result
+*/
+void free_export_disk(export_disk * result);
+
+/**
+* @brief Scans the disks and atomically replaces a .prom file with their metrics
+*
+* The disks are scanned in parallel by the scheduler (sched_scan). The
+* metrics are written to a temporary file in the same directory with one
+* write, and then renamed over filename.
+* @param filename Output .prom file
+* @param disks Disk filenames
+* @param n Number of disks
+* @param source Disk read for each disk (see alias_sources), NULL to read all of them
+* @param threads Disks scanned concurrently (0: as many as the controller slots, see sched_scan)
+* @return 1 on success, 0 on failure
+*/
+int export_metrics(char * filename, char ** disks, int n, const int * source, int threads);
+
+#endif
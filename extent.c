@@ -0,0 +1,200 @@
+/**
+ * @file extent.c
+ * @brief Implementaciones del índice de extensiones de un disco
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "extent.h"
+#include "disk.h"
+
+/**
+* @brief Appends an extent to the index
+* @return 1 on success, 0 on failure
+*/
+static int add_extent(extent_index * index, unsigned long long start, unsigned long long end, unsigned int number, const char * type) {
+	if (index->count == index->capacity) {
+		unsigned int capacity = (index->capacity == 0) ? 16 : index->capacity * 2;
+		unsigned long long * starts = (unsigned long long *)realloc(index->starts, capacity * sizeof(unsigned long long));
+		if (starts != NULL) index->starts = starts;
+		unsigned long long * ends = (unsigned long long *)realloc(index->ends, capacity * sizeof(unsigned long long));
+		if (ends != NULL) index->ends = ends;
+		unsigned int * numbers = (unsigned int *)realloc(index->numbers, capacity * sizeof(unsigned int));
+		if (numbers != NULL) index->numbers = numbers;
+		char ** types = (char **)realloc(index->types, capacity * sizeof(char *));
+		if (types != NULL) index->types = types;
+		if (starts == NULL || ends == NULL || numbers == NULL || types == NULL) return 0;
+		index->capacity = capacity;
+	}
+	index->starts[index->count] = start;
+	index->ends[index->count] = end;
+	index->numbers[index->count] = number;
+	index->types[index->count] = strdup(type);
+	index->count++;
+	return 1;
+}
+
+/**
+* @brief Adds a MBR partition descriptor to the index
+*/
+static int add_mbr_extent(extent_index * index, mbr_partition_descriptor * desc, unsigned long long base, unsigned int number) {
+	char type_name[TYPE_NAME_LEN];
+	if (desc->sectors_in_partition == 0) return 1;
+	mbr_partition_type(desc->partition_type, type_name);
+	return add_extent(index, base + desc->starting_sector_lba,
+		base + desc->starting_sector_lba + desc->sectors_in_partition - 1, number, type_name);
+}
+
+/**
+* @brief Follows the EBR chain of an extended partition and adds its logical partitions
+*/
+static int add_logical_extents(extent_index * index, unsigned long long extended_lba) {
+	mbr ebr;
+	unsigned long long ebr_lba = extended_lba;
+	//El límite evita ciclos en cadenas de EBR dañadas
+	for (unsigned int number = 5; number < 5 + MBR_MAX_LOGICAL; number++) {
+		if (read_lba_sector(index->disk, ebr_lba, (char *)&ebr) == 0 || ebr.signature != MBR_SIGNATURE) {
+			return 0;
+		}
+		//La primera entrada es relativa al EBR actual
+		if (ebr.partition_table[0].partition_type != MBR_TYPE_UNUSED &&
+				!add_mbr_extent(index, &ebr.partition_table[0], ebr_lba, number)) {
+			return 0;
+		}
+		//La segunda entrada apunta al siguiente EBR, relativa al inicio de la partición extendida
+		if (!is_extended_partition(ebr.partition_table[1].partition_type) || ebr.partition_table[1].starting_sector_lba == 0) {
+			return 1;
+		}
+		ebr_lba = extended_lba + ebr.partition_table[1].starting_sector_lba;
+	}
+	return 1;
+}
+
+/**
+* @brief Adds a non-null GPT descriptor to the index (gpt_entry_callback)
+*/
+static int add_gpt_extent(gpt_partition_descriptor * desc, unsigned int number, void * arg) {
+	extent_index * index = (extent_index *)arg;
+	if (is_null_descriptor(desc)) return 1;
+	const gpt_partition_type * type = get_gpt_partition_type_guid(desc->partition_type_guid);
+	return add_extent(index, desc->starting_lba, desc->ending_lba, number + 1, type->description);
+}
+
+/**
+* @brief Sorts the parallel arrays of the index by starting LBA (insertion sort, tables are small and almost sorted)
+*/
+static void sort_extents(extent_index * index) {
+	for (unsigned int i = 1; i < index->count; i++) {
+		unsigned long long start = index->starts[i], end = index->ends[i];
+		unsigned int number = index->numbers[i];
+		char * type = index->types[i];
+		unsigned int j = i;
+		while (j > 0 && index->starts[j - 1] > start) {
+			index->starts[j] = index->starts[j - 1];
+			index->ends[j] = index->ends[j - 1];
+			index->numbers[j] = index->numbers[j - 1];
+			index->types[j] = index->types[j - 1];
+			j--;
+		}
+		index->starts[j] = start;
+		index->ends[j] = end;
+		index->numbers[j] = number;
+		index->types[j] = type;
+	}
+}
+
+int build_extent_index(char * disk, extent_index * index) {
+	mbr boot_record;
+	gpt_header hdr;
+
+	memset(index, 0, sizeof(extent_index));
+	index->disk = disk;
+	if (read_lba_sector(disk, 0, (char *)&boot_record) == 0) {
+		return 0;
+	}
+	if (is_mbr(&boot_record)) {
+		//1. Particiones primarias; las extendidas se reemplazan por sus particiones lógicas
+		for (int i = 0; i < 4; i++) {
+			mbr_partition_descriptor * desc = &boot_record.partition_table[i];
+			if (desc->partition_type == MBR_TYPE_UNUSED) continue;
+			if (is_extended_partition(desc->partition_type)) {
+				if (!add_logical_extents(index, desc->starting_sector_lba)) {
+					fprintf(stderr, "%s: broken EBR chain\n", disk);
+				}
+				continue;
+			}
+			if (!add_mbr_extent(index, desc, 0, i + 1)) {
+				free_extent_index(index);
+				return 0;
+			}
+		}
+	} else {
+		//2. GPT: extensiones tomadas del arreglo de descriptores
+		if (read_lba_sector(disk, 1, (char *)&hdr) == 0 || !is_valid_gpt_header(&hdr) ||
+				gpt_read_entries(disk, &hdr, add_gpt_extent, index) != GPT_ENTRIES_OK) {
+			free_extent_index(index);
+			return 0;
+		}
+	}
+	sort_extents(index);
+	return 1;
+}
+
+void free_extent_index(extent_index * index) {
+	for (unsigned int i = 0; i < index->count; i++) {
+		free(index->types[i]);
+	}
+	free(index->starts);
+	free(index->ends);
+	free(index->numbers);
+	free(index->types);
+	memset(index, 0, sizeof(extent_index));
+}
+
+int lookup_lba(extent_index * index, unsigned long long lba) {
+	const unsigned long long * base = index->starts;
+	unsigned int n = index->count;
+	if (n == 0) return -1;
+	//Búsqueda binaria sin saltos: la comparación se resuelve con un movimiento condicional
+	while (n > 1) {
+		unsigned int half = n / 2;
+		base = (base[half] <= lba) ? base + half : base;
+		n -= half;
+	}
+	int i = base - index->starts;
+	return (index->starts[i] <= lba && lba <= index->ends[i]) ? i : -1;
+}
+
+unsigned long long lookup_lbas(extent_index * index, FILE * in, unsigned int unit) {
+	char line[128];
+	unsigned long long misses = 0;
+	unsigned int factor = unit / SECTOR_SIZE;
+	while (fgets(line, sizeof(line), in) != NULL) {
+		char * end;
+		char * ptr = line;
+		while (isspace((unsigned char)*ptr)) ptr++;
+		if (*ptr == 0 || *ptr == '#') continue;
+		unsigned long long value = strtoull(ptr, &end, 0);
+		if (end == ptr) {
+			fprintf(stderr, "Invalid LBA: %s", line);
+			continue;
+		}
+		//Un LBA de 4K cubre 8 sectores de 512 bytes, todos en la misma partición
+		int i = lookup_lba(index, value * factor);
+		if (i < 0) {
+			printf("%llu\t-\n", value);
+			misses++;
+			continue;
+		}
+		//La extensión se imprime en la misma unidad que el LBA consultado
+		printf("%llu\t%u\t%llu\t%llu\t%s\n", value, index->numbers[i],
+			index->starts[i] / factor, index->ends[i] / factor, index->types[i]);
+	}
+	fflush(stdout);
+	return misses;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file extent.h
+ * @brief Índice de extensiones para resolver a qué partición pertenece un LBA
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef EXTENT_H
+#define EXTENT_H
+
+#include <stdio.h>
+#include "mbr.h"
+#include "gpt.h"
+
+/**
+* @brief Sorted extent index of a disk
+*
+* Stored as parallel arrays so that the binary search only touches starts.
+*/
+typedef struct {
+	char * disk; /*!< Disk filename */
+	unsigned int count; /*!< Number of extents */
+	unsigned int capacity; /*!< Capacity of the arrays */
+	unsigned long long * starts; /*!< Starting LBA of each extent, sorted */
+	unsigned long long * ends; /*!< Ending LBA of each extent */
+	unsigned int * numbers; /*!< Partition number (MBR logical partitions start at 5) */
+	char ** types; /*!< Text description of the partition type */
+} extent_index;
+
+/**
+* @brief Builds the extent index of a disk from its MBR, EBR chain or GPT entries
+* @param disk Disk filename
+* @param index Index to fill
+* @return 1 on success, 0 on failure
+*/
+int build_extent_index(char * disk, extent_index * index);
+
+/**
+* @brief Releases an extent index
+* @param index Index
+*/
+void free_extent_index(extent_index * index);
+
+/**
+* @brief Finds the extent that contains a LBA (branchless binary search)
+* @param index Extent index
+* @param lba LBA in 512-byte sectors
+* @return Position of the extent in the index, -1 if the LBA is not in any partition
+*/
+int lookup_lba(extent_index * index, unsigned long long lba);
+
+/**
+* @brief Resolves the LBAs read from a stream, one per line, and prints their partition
+* @param index Extent index
+* @param in Input stream (decimal or 0x-prefixed LBAs)
+* @param unit Size in bytes of the LBAs read and of the extents printed (512 or 4096)
+* @return Number of LBAs that are not in any partition
+*/
+unsigned long long lookup_lbas(extent_index * index, FILE * in, unsigned int unit);
+
+#endif
@@ -0,0 +1,184 @@
+/**
+ * @file fields.c
+ * @brief Implementaciones del listado con selección de columnas
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "fields.h"
+#include "disk.h"
+
+/** @brief Names of the columns, indexed by field_id */
+static const char * field_names[] = {
+	"disk", "number", "start", "end", "sectors", "size", "type", "typeguid", "guid", "name", "attrs"
+};
+
+/**
+* @brief GPT descriptors read once and printed for every alias of the disk
+*/
+typedef struct {
+	filter_program * filter; /*!< Filter, NULL for all partitions */
+	gpt_partition_descriptor * descs; /*!< Descriptors that match the filter */
+	unsigned int * indexes; /*!< Index of each descriptor in the entry array */
+	unsigned int rows; /*!< Number of descriptors */
+	unsigned int capacity; /*!< Capacity of descs and indexes */
+} field_context;
+
+int parse_fields(char * list, field_list * fields) {
+	char * copy = strdup(list);
+	char * save = NULL;
+	int ok = 1;
+	if (copy == NULL) return 0;
+	fields->count = 0;
+	for (char * name = strtok_r(copy, ",", &save); name != NULL; name = strtok_r(NULL, ",", &save)) {
+		int id = -1;
+		for (int i = 0; i < sizeof(field_names)/sizeof(field_names[0]); i++) {
+			if (strcmp(field_names[i], name) == 0) id = i;
+		}
+		if (id < 0 || fields->count == MAX_FIELDS) {
+			fprintf(stderr, "Unknown field %s\n", name);
+			ok = 0;
+			break;
+		}
+		fields->ids[fields->count++] = (field_id)id;
+	}
+	free(copy);
+	return ok && fields->count > 0;
+}
+
+void print_field_titles(field_list * fields) {
+	for (int i = 0; i < fields->count; i++) {
+		printf("%s%s", i ? "\t" : "", field_names[fields->ids[i]]);
+	}
+	printf("\n");
+}
+
+/**
+* @brief Prints the selected columns of a MBR partition
+*/
+static void print_mbr_fields(char * disk, field_list * fields, mbr_partition_descriptor * desc, unsigned int number) {
+	char type_name[TYPE_NAME_LEN];
+	unsigned long long start = desc->starting_sector_lba;
+	unsigned long long sectors = desc->sectors_in_partition;
+	for (int i = 0; i < fields->count; i++) {
+		if (i) putchar('\t');
+		switch (fields->ids[i]) {
+			case FIELD_DISK: fputs(disk, stdout); break;
+			case FIELD_NUMBER: printf("%u", number); break;
+			case FIELD_START: printf("%llu", start); break;
+			case FIELD_END: printf("%llu", start + sectors - 1); break;
+			case FIELD_SECTORS: printf("%llu", sectors); break;
+			case FIELD_SIZE: printf("%llu", sectors * SECTOR_SIZE); break;
+			case FIELD_TYPE:
+				mbr_partition_type(desc->partition_type, type_name);
+				fputs(type_name, stdout);
+				break;
+			case FIELD_TYPE_GUID: printf("0x%02x", desc->partition_type); break;
+			case FIELD_ATTRS: printf("0x%02x", desc->boot_flag); break;
+			default: putchar('-'); break;
+		}
+	}
+	putchar('\n');
+}
+
+/**
+* @brief Prints the selected columns of a GPT descriptor
+*/
+static void print_gpt_row(char * disk, field_list * fields, gpt_partition_descriptor * desc, unsigned int index) {
+	char * str;
+	for (int i = 0; i < fields->count; i++) {
+		if (i) putchar('\t');
+		//Cada columna se calcula solo si fue pedida
+		switch (fields->ids[i]) {
+			case FIELD_DISK: fputs(disk, stdout); break;
+			case FIELD_NUMBER: printf("%u", index + 1); break;
+			case FIELD_START: printf("%llu", desc->starting_lba); break;
+			case FIELD_END: printf("%llu", desc->ending_lba); break;
+			case FIELD_SECTORS: printf("%llu", desc->ending_lba - desc->starting_lba + 1); break;
+			case FIELD_SIZE: printf("%llu", (desc->ending_lba - desc->starting_lba + 1) * SECTOR_SIZE); break;
+			case FIELD_TYPE:
+				fputs(get_gpt_partition_type_guid(desc->partition_type_guid)->description, stdout);
+				break;
+			case FIELD_TYPE_GUID:
+			case FIELD_GUID:
+				str = guid_to_str((guid *)(fields->ids[i] == FIELD_GUID ? desc->unique_partition_guid : desc->partition_type_guid));
+				fputs(str, stdout);
+				free(str);
+				break;
+			case FIELD_NAME:
+				str = gpt_decode_partition_name((char *)desc->partition_name);
+				fputs(str, stdout);
+				free(str);
+				break;
+			case FIELD_ATTRS: printf("0x%016llx", desc->attributes); break;
+		}
+	}
+	putchar('\n');
+}
+
+/**
+* @brief Keeps a copy of each non-null GPT descriptor that matches the filter (gpt_entry_callback)
+*/
+static int collect_gpt_fields(gpt_partition_descriptor * desc, unsigned int index, void * arg) {
+	field_context * ctx = (field_context *)arg;
+	if (is_null_descriptor(desc) || !filter_match_gpt(ctx->filter, desc, index + 1)) return 1;
+	if (ctx->rows == ctx->capacity) {
+		unsigned int capacity = ctx->capacity ? ctx->capacity * 2 : 16;
+		//Si una reserva falla, los arreglos anteriores siguen en ctx y se liberan al final
+		gpt_partition_descriptor * descs = (gpt_partition_descriptor *)realloc(ctx->descs, capacity * sizeof(gpt_partition_descriptor));
+		if (descs == NULL) return 0;
+		ctx->descs = descs;
+		unsigned int * indexes = (unsigned int *)realloc(ctx->indexes, capacity * sizeof(unsigned int));
+		if (indexes == NULL) return 0;
+		ctx->indexes = indexes;
+		ctx->capacity = capacity;
+	}
+	ctx->descs[ctx->rows] = *desc;
+	ctx->indexes[ctx->rows++] = index;
+	return 1;
+}
+
+int list_fields(char ** disks, int count, field_list * fields, filter_program * filter) {
+	mbr boot_record;
+	gpt_header hdr;
+	char * disk = disks[0];
+	field_context ctx = {filter, NULL, NULL, 0, 0};
+
+	if (read_lba_sector(disk, 0, (char *)&boot_record) == 0) {
+		return 0;
+	}
+	if (is_mbr(&boot_record)) {
+		for (int j = 0; j < count; j++) {
+			for (int i = 0; i < 4; i++) {
+				if (boot_record.partition_table[i].partition_type == MBR_TYPE_UNUSED) continue;
+				if (!filter_match_mbr(filter, &boot_record.partition_table[i], i + 1)) continue;
+				print_mbr_fields(disks[j], fields, &boot_record.partition_table[i], i + 1);
+			}
+		}
+		return 1;
+	}
+	if (read_lba_sector(disk, 1, (char *)&hdr) == 0 || !is_valid_gpt_header(&hdr)) {
+		return 0;
+	}
+	int status = gpt_read_entries(disk, &hdr, collect_gpt_fields, &ctx);
+	if (status == GPT_ENTRIES_OK || status == GPT_ENTRIES_BAD_CRC) {
+		for (int j = 0; j < count; j++) {
+			for (unsigned int r = 0; r < ctx.rows; r++) {
+				print_gpt_row(disks[j], fields, &ctx.descs[r], ctx.indexes[r]);
+			}
+		}
+	}
+	free(ctx.descs);
+	free(ctx.indexes);
+	if (status == GPT_ENTRIES_BAD_CRC) {
+		fprintf(stderr, "%s: warning: partition entry array CRC32 mismatch\n", disk);
+	} else if (status == GPT_ENTRIES_STOPPED) {
+		fprintf(stderr, "Out of memory\n");
+	}
+	return status == GPT_ENTRIES_OK || status == GPT_ENTRIES_BAD_CRC;
+}
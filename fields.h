@@ -0,0 +1,74 @@
+/**
+ * @file fields.h
+ * @brief Listado de particiones con selección de columnas
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef FIELDS_H
+#define FIELDS_H
+
+#include "mbr.h"
+#include "gpt.h"
+#include "filter.h"
+
+/** @brief Maximum number of columns in a field list */
+#define MAX_FIELDS 16
+
+/**
+* @brief Column that can be selected with --fields
+*/
+typedef enum {
+	FIELD_DISK, /*!< Disk filename */
+	FIELD_NUMBER, /*!< Partition number */
+	FIELD_START, /*!< Starting LBA */
+	FIELD_END, /*!< Ending LBA */
+	FIELD_SECTORS, /*!< Number of sectors */
+	FIELD_SIZE, /*!< Size in bytes */
+	FIELD_TYPE, /*!< Type description */
+	FIELD_TYPE_GUID, /*!< Type GUID (GPT) or type byte (MBR) */
+	FIELD_GUID, /*!< Unique partition GUID */
+	FIELD_NAME, /*!< Partition name */
+	FIELD_ATTRS /*!< GPT attributes or MBR boot flag */
+} field_id;
+
+/**
+* @brief List of selected columns, in output order
+*/
+typedef struct {
+	int count; /*!< Number of columns */
+	field_id ids[MAX_FIELDS]; /*!< Columns */
+} field_list;
+
+/**
+* @brief Parses a comma-separated list of column names
+* @param list Column names (disk, number, start, end, sectors, size, type, typeguid, guid, name, attrs)
+* @param fields List to fill
+* @return 1 on success, 0 if a name is unknown or there are too many columns
+*/
+int parse_fields(char * list, field_list * fields);
+
+/**
+* @brief Prints the selected columns of every partition of a disk
+*
+* Only the selected columns are computed: type lookups, GUID formatting and
+* name decoding are skipped when they are not requested, and the filter is
+* evaluated on the raw descriptor before any column is formatted. The table is
+* read from the first disk and its rows are printed for every alias.
+* @param disks Aliases of the disk
+* @param count Number of aliases
+* @param fields Selected columns
+* @param filter Only partitions matching this filter are printed (NULL for all)
+* @return 1 on success, 0 on failure
+*/
+int list_fields(char ** disks, int count, field_list * fields, filter_program * filter);
+
+/**
+* @brief Prints the names of the selected columns
+* @param fields Selected columns
+*/
+void print_field_titles(field_list * fields);
+
+#endif
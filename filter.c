@@ -0,0 +1,215 @@
+/**
+ * @file filter.c
+ * @brief Implementaciones de los filtros compilados
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include "filter.h"
+#include "disk.h"
+
+/** @brief Fields that take an operator, in the same order as filter_field */
+static const char * filter_field_names[] = {
+	"type", "size", "start", "end", "sectors", "number", "name"
+};
+
+/** @brief Named GPT attribute bits */
+static const struct {
+	const char * name; /*!< Name used after "attr." */
+	unsigned int bit; /*!< Bit number */
+} filter_attributes[] = {
+	{ "required", 0 },
+	{ "noblock", 1 },
+	{ "legacy", 2 },
+	{ "boot", 2 },
+};
+
+/**
+* @brief Parses a number with an optional K, M, G or T (binary) suffix
+* @return 1 on success, 0 otherwise
+*/
+static int parse_number(const char * str, unsigned long long * value) {
+	char * end;
+	*value = strtoull(str, &end, 0);
+	if (end == str) return 0;
+	//Sin break: cada sufijo aplica también los desplazamientos de los menores
+	switch (toupper((unsigned char)*end)) {
+		case 'T': *value <<= 10;
+		case 'G': *value <<= 10;
+		case 'M': *value <<= 10;
+		case 'K': *value <<= 10;
+			end++;
+			break;
+	}
+	return *end == 0;
+}
+
+/**
+* @brief Compiles one predicate
+*/
+static int compile_predicate(char * expr, filter_predicate * pred) {
+	static const struct {
+		const char * text;
+		filter_op op;
+	} ops[] = {
+		{ "!=", FILTER_NE }, { "<=", FILTER_LE }, { ">=", FILTER_GE },
+		{ "=", FILTER_EQ }, { "<", FILTER_LT }, { ">", FILTER_GT }, { "~", FILTER_CONTAINS },
+	};
+	memset(pred, 0, sizeof(filter_predicate));
+	if (*expr == '!') {
+		pred->negate = 1;
+		expr++;
+	}
+	//1. Atributos: attr.<nombre> o attr.<bit>
+	if (strncmp(expr, "attr.", 5) == 0) {
+		char * name = expr + 5;
+		char * end;
+		pred->field = FILTER_ATTR;
+		pred->op = FILTER_SET;
+		for (int i = 0; i < sizeof(filter_attributes)/sizeof(filter_attributes[0]); i++) {
+			if (strcmp(filter_attributes[i].name, name) == 0) {
+				pred->value = filter_attributes[i].bit;
+				return 1;
+			}
+		}
+		pred->value = strtoul(name, &end, 10);
+		return end != name && *end == 0 && pred->value < 64;
+	}
+	//2. Campo, operador y valor
+	size_t len = strcspn(expr, "!<>=~");
+	char * value = NULL;
+	int field = -1;
+	for (int i = 0; i < sizeof(filter_field_names)/sizeof(filter_field_names[0]); i++) {
+		if (strlen(filter_field_names[i]) == len && strncmp(filter_field_names[i], expr, len) == 0) field = i;
+	}
+	if (field < 0) return 0;
+	pred->field = (filter_field)field;
+	for (int i = 0; i < sizeof(ops)/sizeof(ops[0]); i++) {
+		if (strncmp(expr + len, ops[i].text, strlen(ops[i].text)) == 0) {
+			pred->op = ops[i].op;
+			value = expr + len + strlen(ops[i].text);
+			break;
+		}
+	}
+	if (value == NULL || *value == 0) return 0;
+	//3. El operando se convierte una sola vez al formato de los descriptores
+	if (pred->field == FILTER_NAME) {
+		if (strlen(value) >= FILTER_PATTERN_LEN) return 0;
+		strcpy(pred->pattern, value);
+		return pred->op == FILTER_CONTAINS || pred->op == FILTER_EQ || pred->op == FILTER_NE;
+	}
+	if (pred->op == FILTER_CONTAINS) return 0;
+	if (pred->field == FILTER_TYPE) {
+		if (pred->op != FILTER_EQ && pred->op != FILTER_NE) return 0;
+		pred->has_guid = gpt_type_from_name(value, (guid *)pred->guid);
+		//Los tipos MBR se dan como número (type=0x83)
+		if (!pred->has_guid && !parse_number(value, &pred->value)) return 0;
+		return 1;
+	}
+	return parse_number(value, &pred->value);
+}
+
+int compile_filter(char * expr, filter_program * program) {
+	char * copy = strdup(expr);
+	char * save = NULL;
+	int ok = 1;
+	if (copy == NULL) return 0;
+	for (char * clause = strtok_r(copy, ",", &save); clause != NULL; clause = strtok_r(NULL, ",", &save)) {
+		if (program->count == MAX_PREDICATES || !compile_predicate(clause, &program->predicates[program->count])) {
+			fprintf(stderr, "Invalid filter %s\n", clause);
+			ok = 0;
+			break;
+		}
+		program->count++;
+	}
+	free(copy);
+	return ok;
+}
+
+/**
+* @brief Compares two numbers with an operator
+*/
+static int compare(filter_op op, unsigned long long a, unsigned long long b) {
+	switch (op) {
+		case FILTER_EQ: return a == b;
+		case FILTER_NE: return a != b;
+		case FILTER_LT: return a < b;
+		case FILTER_LE: return a <= b;
+		case FILTER_GT: return a > b;
+		case FILTER_GE: return a >= b;
+		default: return 0;
+	}
+}
+
+/**
+* @brief Tests a name pattern directly on the UTF-16LE partition name
+*/
+static int match_name(filter_predicate * pred, const unsigned char name[72]) {
+	char ascii[37];
+	int len = 0;
+	//Solo se toma el byte bajo de cada carácter, hasta el primer carácter nulo
+	while (len < 36 && (name[len * 2] != 0 || name[len * 2 + 1] != 0)) {
+		ascii[len] = name[len * 2];
+		len++;
+	}
+	ascii[len] = 0;
+	if (pred->op == FILTER_CONTAINS) return strstr(ascii, pred->pattern) != NULL;
+	return (strcmp(ascii, pred->pattern) == 0) == (pred->op == FILTER_EQ);
+}
+
+int filter_match_gpt(filter_program * program, gpt_partition_descriptor * desc, unsigned int number) {
+	if (program == NULL) return 1;
+	for (int i = 0; i < program->count; i++) {
+		filter_predicate * pred = &program->predicates[i];
+		unsigned long long sectors = desc->ending_lba - desc->starting_lba + 1;
+		int result;
+		switch (pred->field) {
+			case FILTER_TYPE:
+				result = pred->has_guid && memcmp(desc->partition_type_guid, pred->guid, 16) == 0;
+				if (pred->op == FILTER_NE) result = !result;
+				break;
+			case FILTER_SIZE: result = compare(pred->op, sectors * SECTOR_SIZE, pred->value); break;
+			case FILTER_START: result = compare(pred->op, desc->starting_lba, pred->value); break;
+			case FILTER_END: result = compare(pred->op, desc->ending_lba, pred->value); break;
+			case FILTER_SECTORS: result = compare(pred->op, sectors, pred->value); break;
+			case FILTER_NUMBER: result = compare(pred->op, number, pred->value); break;
+			case FILTER_NAME: result = match_name(pred, desc->partition_name); break;
+			case FILTER_ATTR: result = (desc->attributes >> pred->value) & 1; break;
+			default: result = 0; break;
+		}
+		if (result == pred->negate) return 0;
+	}
+	return 1;
+}
+
+int filter_match_mbr(filter_program * program, mbr_partition_descriptor * desc, unsigned int number) {
+	if (program == NULL) return 1;
+	for (int i = 0; i < program->count; i++) {
+		filter_predicate * pred = &program->predicates[i];
+		unsigned long long sectors = desc->sectors_in_partition;
+		int result;
+		switch (pred->field) {
+			case FILTER_TYPE:
+				result = !pred->has_guid && desc->partition_type == pred->value;
+				if (pred->op == FILTER_NE) result = !result;
+				break;
+			case FILTER_SIZE: result = compare(pred->op, sectors * SECTOR_SIZE, pred->value); break;
+			case FILTER_START: result = compare(pred->op, desc->starting_sector_lba, pred->value); break;
+			case FILTER_END: result = compare(pred->op, desc->starting_sector_lba + sectors - 1, pred->value); break;
+			case FILTER_SECTORS: result = compare(pred->op, sectors, pred->value); break;
+			case FILTER_NUMBER: result = compare(pred->op, number, pred->value); break;
+			case FILTER_NAME: result = 0; break;
+			//En MBR solo existe el indicador de arranque (attr.boot / attr.legacy)
+			case FILTER_ATTR: result = pred->value == 2 && desc->boot_flag == 0x80; break;
+			default: result = 0; break;
+		}
+		if (result == pred->negate) return 0;
+	}
+	return 1;
+}
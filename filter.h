@@ -0,0 +1,102 @@
+/**
+ * @file filter.h
+ * @brief Filtros compilados sobre los descriptores de partición
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "mbr.h"
+#include "gpt.h"
+
+/** @brief Maximum number of predicates in a filter program */
+#define MAX_PREDICATES 32
+
+/** @brief Maximum length of a name pattern */
+#define FILTER_PATTERN_LEN 37
+
+/**
+* @brief Partition field tested by a predicate
+*/
+typedef enum {
+	FILTER_TYPE, /*!< Type GUID (GPT) or type byte (MBR) */
+	FILTER_SIZE, /*!< Size in bytes */
+	FILTER_START, /*!< Starting LBA */
+	FILTER_END, /*!< Ending LBA */
+	FILTER_SECTORS, /*!< Number of sectors */
+	FILTER_NUMBER, /*!< Partition number */
+	FILTER_NAME, /*!< Partition name (GPT) */
+	FILTER_ATTR /*!< Attribute bit (GPT) or boot flag (MBR) */
+} filter_field;
+
+/**
+* @brief Comparison made by a predicate
+*/
+typedef enum {
+	FILTER_EQ, /*!< = */
+	FILTER_NE, /*!< != */
+	FILTER_LT, /*!< < */
+	FILTER_LE, /*!< <= */
+	FILTER_GT, /*!< > */
+	FILTER_GE, /*!< >= */
+	FILTER_CONTAINS, /*!< ~ */
+	FILTER_SET /*!< attribute bit set */
+} filter_op;
+
+/**
+* @brief Compiled predicate
+*/
+typedef struct {
+	filter_field field; /*!< Field tested */
+	filter_op op; /*!< Comparison */
+	int negate; /*!< 1 if the result is inverted */
+	unsigned long long value; /*!< Numeric operand, MBR type or attribute bit */
+	unsigned char guid[16]; /*!< Type GUID operand, in on-disk byte order */
+	int has_guid; /*!< 1 if guid is valid (type given as alias or GUID) */
+	char pattern[FILTER_PATTERN_LEN]; /*!< Name operand */
+} filter_predicate;
+
+/**
+* @brief Filter program: all its predicates must match
+*/
+typedef struct {
+	int count; /*!< Number of predicates */
+	filter_predicate predicates[MAX_PREDICATES]; /*!< Predicates */
+} filter_program;
+
+/**
+* @brief Compiles a comma-separated list of predicates and appends it to a program
+*
+* Predicates: [!]field op value, with field in type, size, start, end, sectors,
+* number and name; op in =, !=, <, <=, >, >= and ~ (name contains); sizes accept
+* K, M, G and T suffixes. attr.required, attr.noblock, attr.legacy and attr.N
+* test GPT attribute bits (attr.boot tests the MBR boot flag).
+* @param expr Expression
+* @param program Program to extend
+* @return 1 on success, 0 if the expression is invalid
+*/
+int compile_filter(char * expr, filter_program * program);
+
+/**
+* @brief Evaluates a program on a raw GPT descriptor
+* @param program Program (NULL matches everything)
+* @param desc Descriptor
+* @param number Partition number
+* @return 1 if the descriptor matches, 0 otherwise
+*/
+int filter_match_gpt(filter_program * program, gpt_partition_descriptor * desc, unsigned int number);
+
+/**
+* @brief Evaluates a program on a raw MBR descriptor
+* @param program Program (NULL matches everything)
+* @param desc Descriptor
+* @param number Partition number
+* @return 1 if the descriptor matches, 0 otherwise
+*/
+int filter_match_mbr(filter_program * program, mbr_partition_descriptor * desc, unsigned int number);
+
+#endif
@@ -8,11 +8,39 @@
 */
 
 #ifndef GPT_H
+#define GPT_H
 
 #define GPT_HEADER_SIGNATURE 0x5452415020494645ULL  // 'EFI PART' en little-endian, ULL es usado para indicar que es un unsigned long long
 
 #include "mbr.h"
 
+/** @brief Maximum number of entries accepted in a partition entry array */
+#define GPT_MAX_PARTITION_ENTRIES 16384
+
+/** @brief Maximum size of a partition entry accepted, in bytes */
+#define GPT_MAX_ENTRY_SIZE 4096
+
+/** @brief Maximum size of a partition entry array accepted, in bytes */
+#define GPT_MAX_ARRAY_SIZE (4 * 1024 * 1024)
+
+/** @brief Default window used to read the partition entry array, in sectors */
+#define GPT_DEFAULT_WINDOW 256
+
+/** @brief The partition entry array was read and its CRC32 matches the header */
+#define GPT_ENTRIES_OK 1
+
+/** @brief A sector of the partition entry array could not be read */
+#define GPT_ENTRIES_READ_ERROR 0
+
+/** @brief The partition entry array was read but its CRC32 does not match the header */
+#define GPT_ENTRIES_BAD_CRC -1
+
+/** @brief The header describes an entry array outside the accepted limits */
+#define GPT_ENTRIES_OUT_OF_LIMITS -2
+
+/** @brief The callback stopped the iteration */
+#define GPT_ENTRIES_STOPPED -3
+
 /**
 * @brief GUID
 * @see https://uefi.org/specs/UEFI/2.10/Apx_A_GUID_and_Time_Formats.html
@@ -59,6 +87,18 @@ typedef struct {
 	unsigned char partition_name[72]; /*!< Partition name */	
 }__attribute__((packed)) gpt_partition_descriptor;
 
+/**
+* @brief Callback invoked for each entry of the partition entry array
+* @param desc Entry (the first 128 bytes of the entry, null entries included)
+* @param index Index of the entry in the array
+* @param arg User argument
+* @return 1 to continue, 0 to stop the iteration
+*/
+typedef int (*gpt_entry_callback)(gpt_partition_descriptor * desc, unsigned int index, void * arg);
+
+/** @brief Window used to read the partition entry array, in sectors (GPT_DEFAULT_WINDOW by default) */
+extern unsigned int gpt_window_sectors;
+
 /**
 * @brief GPT Partition type
 */
@@ -71,11 +111,19 @@ typedef struct {
 /**
  * @brief Get the gpt partition type of a partition 
  * 
- * @param guid_str GUID of the partition
+ * @param guid_str GUID of the partition (case insensitive)
  * @return const gpt_partition_type* partition type
  */
 const gpt_partition_type* get_gpt_partition_type(char * guid_str);
 
+/**
+ * @brief Get the gpt partition type of a binary type GUID
+ *
+ * @param type_guid Type GUID, in on-disk byte order
+ * @return const gpt_partition_type* partition type
+ */
+const gpt_partition_type* get_gpt_partition_type_guid(const unsigned char type_guid[16]);
+
 /**
 * @brief Decodes a two-byte encoded partition name
 * @param name two-byte encoded partition name
@@ -97,6 +145,40 @@ int is_protective_mbr(mbr * boot_record);
 int is_valid_gpt_header(gpt_header * hdr);
 
 
+/**
+* @brief Checks the CRC32 of a GPT header
+* @param hdr GPT header (a full sector)
+* @return 1 if header_crc32 matches the header contents, 0 otherwise.
+*/
+int gpt_header_crc_ok(gpt_header * hdr);
+
+/**
+* @brief Checks that the entry array described by a header is within the accepted limits
+* @param hdr GPT header
+* @return 1 if the entry array is within limits, 0 otherwise.
+*/
+int gpt_entries_within_limits(gpt_header * hdr);
+
+/**
+* @brief Number of sectors used by the partition entry array
+* @param hdr GPT header (should be within limits)
+* @return Number of sectors of the entry array
+*/
+unsigned long long gpt_array_sectors(gpt_header * hdr);
+
+/**
+* @brief Reads the partition entry array in fixed-size windows
+*
+* Memory use is bounded by gpt_window_sectors, whatever the header claims. The
+* CRC32 of the array is computed while it is read and checked at the end.
+* @param disk Disk filename
+* @param hdr GPT header
+* @param callback Function invoked for each entry
+* @param arg User argument passed to callback
+* @return GPT_ENTRIES_OK, GPT_ENTRIES_READ_ERROR, GPT_ENTRIES_BAD_CRC, GPT_ENTRIES_OUT_OF_LIMITS or GPT_ENTRIES_STOPPED
+*/
+int gpt_read_entries(char * disk, gpt_header * hdr, gpt_entry_callback callback, void * arg);
+
 /**
 * @brief Checks if the GPT partition descriptor is null (not used)
 * @param desc Descriptor
@@ -112,4 +194,20 @@ int is_null_descriptor(gpt_partition_descriptor * desc);
 */
 char * guid_to_str(guid * buf);
 
+/**
+* @brief Parses the text representation of a GUID
+* @param str Text GUID (xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx)
+* @param buf GUID to fill, in on-disk byte order
+* @return 1 on success, 0 if str is not a valid GUID
+*/
+int str_to_guid(const char * str, guid * buf);
+
+/**
+* @brief Resolves a short partition type alias (esp, linux, swap, ...) or a text GUID
+* @param name Alias or text GUID
+* @param buf GUID to fill, in on-disk byte order
+* @return 1 on success, 0 if name is neither a known alias nor a valid GUID
+*/
+int gpt_type_from_name(const char * name, guid * buf);
+
 #endif
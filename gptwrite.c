@@ -0,0 +1,354 @@
+/**
+ * @file gptwrite.c
+ * @brief Implementaciones para la escritura de tablas GPT
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "gptwrite.h"
+#include "crc32.h"
+#include "disk.h"
+
+/** @brief GPT revision 1.0 */
+#define GPT_REVISION 0x00010000
+
+/** @brief Size of the GPT header covered by header_crc32 */
+#define GPT_HEADER_SIZE 92
+
+/**
+* @brief Encodes an ASCII partition name as UTF-16LE
+*/
+static void gpt_encode_partition_name(const char * name, unsigned char buf[72]) {
+	memset(buf, 0, 72);
+	for (int i = 0; i < 36 && name[i] != 0; i++) {
+		buf[i * 2] = name[i];
+	}
+}
+
+int parse_gpt_spec(char * filename, gpt_spec * spec) {
+	FILE * fd;
+	char line[256];
+	int line_number = 0;
+	unsigned int capacity = 0;
+
+	memset(spec, 0, sizeof(gpt_spec));
+	spec->num_partition_entries = GPT_DEFAULT_ENTRIES;
+	fd = fopen(filename, "r");
+	if (fd == NULL) {
+		fprintf(stderr, "Unable to open spec %s\n", filename);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), fd) != NULL) {
+		char keyword[32], type[64], start[32], end[32], attrs[32], name[64];
+		char * comment = strchr(line, '#');
+		int fields;
+		line_number++;
+		if (comment != NULL) *comment = 0;
+		memset(attrs, 0, sizeof(attrs));
+		memset(name, 0, sizeof(name));
+		fields = sscanf(line, "%31s %63s %31s %31s %31s %63[^\n]", keyword, type, start, end, attrs, name);
+		if (fields <= 0) continue;
+		//1. Directivas globales del disco
+		if (strcmp(keyword, "size") == 0 && fields == 2) {
+			spec->sectors = strtoull(type, NULL, 0);
+		} else if (strcmp(keyword, "entries") == 0 && fields == 2) {
+			//Los mismos límites que se exigen al leer el arreglo (gpt_entries_within_limits)
+			char * tail;
+			unsigned long entries = strtoul(type, &tail, 0);
+			if (*tail != 0 || type[0] == '-' || entries == 0 || entries > GPT_MAX_PARTITION_ENTRIES ||
+					entries * sizeof(gpt_partition_descriptor) > GPT_MAX_ARRAY_SIZE) {
+				fprintf(stderr, "%s:%d: entries must be between 1 and %d\n", filename, line_number, GPT_MAX_PARTITION_ENTRIES);
+				break;
+			}
+			spec->num_partition_entries = entries;
+		} else if (strcmp(keyword, "disk-guid") == 0 && fields == 2 && str_to_guid(type, &spec->disk_guid)) {
+			spec->has_disk_guid = 1;
+		} else if (strcmp(keyword, "part") == 0 && fields >= 4) {
+			//2. Descriptor de partición: tipo, inicio, fin, atributos y nombre
+			gpt_partition_descriptor * desc;
+			if (spec->count == capacity) {
+				capacity = (capacity == 0) ? 8 : capacity * 2;
+				desc = (gpt_partition_descriptor *)realloc(spec->partitions, capacity * sizeof(gpt_partition_descriptor));
+				if (desc == NULL) break;
+				spec->partitions = desc;
+			}
+			desc = &spec->partitions[spec->count];
+			memset(desc, 0, sizeof(gpt_partition_descriptor));
+			if (!gpt_type_from_name(type, (guid *)desc->partition_type_guid)) {
+				fprintf(stderr, "%s:%d: unknown partition type %s\n", filename, line_number, type);
+				break;
+			}
+			desc->starting_lba = strtoull(start, NULL, 0);
+			desc->ending_lba = (strcmp(end, "last") == 0) ? 0 : strtoull(end, NULL, 0);
+			desc->attributes = (fields >= 5) ? strtoull(attrs, NULL, 0) : 0;
+			gpt_encode_partition_name(name, desc->partition_name);
+			spec->count++;
+		} else {
+			fprintf(stderr, "%s:%d: invalid directive\n", filename, line_number);
+			break;
+		}
+	}
+	if (!feof(fd)) {
+		fclose(fd);
+		free_gpt_spec(spec);
+		return 0;
+	}
+	fclose(fd);
+	if (spec->count > spec->num_partition_entries) {
+		fprintf(stderr, "%s: %u partitions do not fit in %u entries\n", filename, spec->count, spec->num_partition_entries);
+		free_gpt_spec(spec);
+		return 0;
+	}
+	return 1;
+}
+
+void free_gpt_spec(gpt_spec * spec) {
+	free(spec->partitions);
+	spec->partitions = NULL;
+	spec->count = 0;
+}
+
+/**
+* @brief Fills a GUID with random bytes (version 4, RFC 4122 variant)
+*/
+static void random_guid(unsigned char bytes[16], FILE * urandom) {
+	if (urandom == NULL || fread(bytes, 1, 16, urandom) != 16) {
+		for (int i = 0; i < 16; i++) bytes[i] = rand() & 0xff;
+	}
+	bytes[7] = (bytes[7] & 0x0f) | 0x40;
+	bytes[8] = (bytes[8] & 0x3f) | 0x80;
+}
+
+/**
+* @brief Fills a GPT header and computes its CRC32
+*/
+static void fill_gpt_header(gpt_header * hdr, unsigned long long my_lba, unsigned long long alternate_lba,
+		unsigned long long first_usable_lba, unsigned long long last_usable_lba, guid * disk_guid,
+		unsigned long long partition_entry_lba, unsigned int entries, unsigned int array_crc32) {
+	memset(hdr, 0, sizeof(gpt_header));
+	hdr->signature = GPT_HEADER_SIGNATURE;
+	hdr->revision = GPT_REVISION;
+	hdr->header_size = GPT_HEADER_SIZE;
+	hdr->my_lba = my_lba;
+	hdr->alternate_lba = alternate_lba;
+	hdr->first_usable_lba = first_usable_lba;
+	hdr->last_usable_lba = last_usable_lba;
+	hdr->disk_guid = *disk_guid;
+	hdr->partition_entry_lba = partition_entry_lba;
+	hdr->num_partition_entries = entries;
+	hdr->size_partition_entry = sizeof(gpt_partition_descriptor);
+	hdr->partition_entry_array_crc32 = array_crc32;
+	hdr->header_crc32 = crc32(0, hdr, GPT_HEADER_SIZE);
+}
+
+/**
+* @brief Rounds an offset up to a multiple of the block size, without passing the end of the disk
+*/
+static unsigned long long align_up(unsigned long long offset, unsigned long long block, unsigned long long end) {
+	unsigned long long aligned = (offset + block - 1) / block * block;
+	return (aligned > end) ? end : aligned;
+}
+
+/**
+* @brief Reads the current contents of a range of the disk; bytes past the end of the file read as zeros
+* @return 1 on success, 0 on failure
+*/
+static int read_existing(int fd, unsigned char * buf, size_t size, unsigned long long offset) {
+	size_t done = 0;
+	while (done < size) {
+		ssize_t n = pread(fd, buf + done, size - done, offset + done);
+		if (n < 0) return 0;
+		if (n == 0) break;
+		done += n;
+	}
+	memset(buf + done, 0, size - done);
+	return 1;
+}
+
+int write_gpt_image(char * path, gpt_spec * spec) {
+	int fd;
+	int status = 0;
+	unsigned char * primary = NULL;
+	unsigned char * backup = NULL;
+	gpt_partition_descriptor * entries;
+	guid disk_guid;
+	struct stat st;
+	FILE * urandom;
+
+	//1. Abrir la imagen y determinar su tamaño en sectores
+	fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (fd < 0) {
+		fprintf(stderr, "%s: unable to open image\n", path);
+		return 0;
+	}
+	unsigned long long size = disk_size_sectors(path) * SECTOR_SIZE;
+	unsigned long long sectors = spec->sectors ? spec->sectors : size / SECTOR_SIZE;
+	unsigned long long array_sectors = ((unsigned long long)spec->num_partition_entries * sizeof(gpt_partition_descriptor) + SECTOR_SIZE - 1) / SECTOR_SIZE;
+	unsigned long long first_usable = 2 + array_sectors;
+	if (sectors < 2 * first_usable + 1) {
+		fprintf(stderr, "%s: image too small (%llu sectors)\n", path, sectors);
+		close(fd);
+		return 0;
+	}
+	unsigned long long last_usable = sectors - 2 - array_sectors;
+	if (size < sectors * SECTOR_SIZE) {
+		if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || ftruncate(fd, sectors * SECTOR_SIZE) != 0) {
+			fprintf(stderr, "%s: image smaller than %llu sectors\n", path, sectors);
+			close(fd);
+			return 0;
+		}
+	}
+
+	//2. Reservar las dos regiones: MBR + encabezado + arreglo al inicio, arreglo + encabezado al final,
+	//ampliadas a bloques físicos completos para que el dispositivo no tenga que leer antes de escribir
+	unsigned long long block = disk_block_size(fd);
+	unsigned long long disk_end = sectors * SECTOR_SIZE;
+	unsigned long long primary_end = (2 + array_sectors) * SECTOR_SIZE;
+	unsigned long long backup_start = (sectors - 1 - array_sectors) * SECTOR_SIZE;
+	unsigned long long primary_size = align_up(primary_end, block, disk_end);
+	unsigned long long backup_offset = backup_start / block * block;
+	unsigned long long backup_size = align_up(disk_end, block, disk_end) - backup_offset;
+	if (posix_memalign((void **)&primary, GPT_WRITE_ALIGN, primary_size) != 0 ||
+			posix_memalign((void **)&backup, GPT_WRITE_ALIGN, backup_size) != 0) {
+		fprintf(stderr, "%s: out of memory\n", path);
+		goto out;
+	}
+	//2.1 El relleno hasta el final del bloque conserva el contenido actual del disco
+	memset(primary, 0, primary_end);
+	if (!read_existing(fd, primary + primary_end, primary_size - primary_end, primary_end)) {
+		fprintf(stderr, "%s: read failed\n", path);
+		goto out;
+	}
+	entries = (gpt_partition_descriptor *)(primary + 2 * SECTOR_SIZE);
+
+	//3. Copiar los descriptores, generando GUIDs únicos para esta imagen
+	urandom = fopen("/dev/urandom", "r");
+	if (spec->has_disk_guid) {
+		disk_guid = spec->disk_guid;
+	} else {
+		random_guid((unsigned char *)&disk_guid, urandom);
+	}
+	for (unsigned int i = 0; i < spec->count; i++) {
+		entries[i] = spec->partitions[i];
+		random_guid(entries[i].unique_partition_guid, urandom);
+		if (entries[i].ending_lba == 0) {
+			entries[i].ending_lba = last_usable;
+		}
+	}
+	if (urandom != NULL) fclose(urandom);
+
+	//4. Validar que las particiones estén dentro del área usable y no se traslapen
+	for (unsigned int i = 0; i < spec->count; i++) {
+		if (entries[i].starting_lba < first_usable || entries[i].ending_lba > last_usable ||
+				entries[i].starting_lba > entries[i].ending_lba) {
+			fprintf(stderr, "%s: partition %u (%llu-%llu) outside usable area %llu-%llu\n", path, i + 1,
+				entries[i].starting_lba, entries[i].ending_lba, first_usable, last_usable);
+			goto out;
+		}
+		for (unsigned int j = 0; j < i; j++) {
+			if (entries[i].starting_lba <= entries[j].ending_lba && entries[j].starting_lba <= entries[i].ending_lba) {
+				fprintf(stderr, "%s: partitions %u and %u overlap\n", path, j + 1, i + 1);
+				goto out;
+			}
+		}
+	}
+
+	//5. MBR de protección
+	mbr * pmbr = (mbr *)primary;
+	mbr_partition_descriptor * pe = &pmbr->partition_table[0];
+	pe->initial_sector[1] = 0x02;
+	pe->partition_type = MBR_TYPE_GPT;
+	memset(pe->final_sector, 0xff, 3);
+	pe->starting_sector_lba = 1;
+	pe->sectors_in_partition = (sectors - 1 > 0xffffffffULL) ? 0xffffffff : sectors - 1;
+	pmbr->signature = MBR_SIGNATURE;
+
+	//6. El CRC del arreglo se calcula una sola vez y se comparte entre ambos encabezados
+	unsigned int array_crc32 = crc32(0, entries, (size_t)spec->num_partition_entries * sizeof(gpt_partition_descriptor));
+	fill_gpt_header((gpt_header *)(primary + SECTOR_SIZE), 1, sectors - 1, first_usable, last_usable,
+		&disk_guid, 2, spec->num_partition_entries, array_crc32);
+	unsigned char * backup_array = backup + (backup_start - backup_offset);
+	memcpy(backup_array, entries, array_sectors * SECTOR_SIZE);
+	fill_gpt_header((gpt_header *)(backup_array + array_sectors * SECTOR_SIZE), sectors - 1, 1, first_usable, last_usable,
+		&disk_guid, sectors - 1 - array_sectors, spec->num_partition_entries, array_crc32);
+
+	//7. Una escritura por región y una sola sincronización; el relleno de la copia de respaldo se lee
+	//después de escribir la primaria, por si en un disco pequeño ambos bloques coinciden
+	if (pwrite(fd, primary, primary_size, 0) != (ssize_t)primary_size ||
+			!read_existing(fd, backup, backup_start - backup_offset, backup_offset) ||
+			pwrite(fd, backup, backup_size, backup_offset) != (ssize_t)backup_size ||
+			fsync(fd) != 0) {
+		fprintf(stderr, "%s: write failed\n", path);
+		goto out;
+	}
+	status = 1;
+out:
+	free(primary);
+	free(backup);
+	close(fd);
+	return status;
+}
+
+/**
+* @brief Shared state of the writer threads
+*/
+typedef struct {
+	char ** paths; /*!< Image filenames */
+	int n; /*!< Number of images */
+	gpt_spec * spec; /*!< Layout specification */
+	int next; /*!< Next image to write */
+	int failures; /*!< Images that could not be written */
+} gpt_write_job;
+
+/**
+* @brief Writer thread: takes the next pending image until there are none left
+*/
+static void * gpt_write_worker(void * arg) {
+	gpt_write_job * job = (gpt_write_job *)arg;
+	int i;
+	while ((i = __sync_fetch_and_add(&job->next, 1)) < job->n) {
+		if (!write_gpt_image(job->paths[i], job->spec)) {
+			__sync_fetch_and_add(&job->failures, 1);
+		}
+	}
+	return NULL;
+}
+
+int write_gpt_images(char ** paths, int n, gpt_spec * spec, int jobs) {
+	gpt_write_job job = {paths, n, spec, 0, 0};
+	pthread_t * threads;
+	int started = 0;
+
+	if (jobs <= 0) {
+		jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+	if (jobs > n) jobs = n;
+	if (jobs <= 1) {
+		gpt_write_worker(&job);
+		return job.failures;
+	}
+	threads = (pthread_t *)malloc(jobs * sizeof(pthread_t));
+	if (threads != NULL) {
+		for (; started < jobs; started++) {
+			if (pthread_create(&threads[started], NULL, gpt_write_worker, &job) != 0) break;
+		}
+	}
+	//Si no se pudo crear ningún hilo, escribir en el hilo actual
+	if (started == 0) {
+		gpt_write_worker(&job);
+	}
+	for (int i = 0; i < started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+	return job.failures;
+}
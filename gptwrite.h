@@ -0,0 +1,73 @@
+/**
+ * @file gptwrite.h
+ * @brief Escritura de tablas GPT a partir de una especificación compacta
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef GPTWRITE_H
+#define GPTWRITE_H
+
+#include "gpt.h"
+
+/** @brief Default number of entries in the partition entry array */
+#define GPT_DEFAULT_ENTRIES 128
+
+/** @brief Alignment of the buffers, in bytes (writes are aligned to the physical block of the disk) */
+#define GPT_WRITE_ALIGN 4096
+
+/**
+* @brief Layout specification used to write GPT tables
+*
+* Spec file format (one directive per line, '#' starts a comment):
+* @code
+* size 20480                  # disk size in sectors (optional, defaults to the image size)
+* entries 128                 # entries in the partition entry array (optional)
+* disk-guid <GUID>            # disk GUID (optional, random per image)
+* part esp 2048 4095 0 EFI    # type (alias or GUID), start, end|last, [attributes], [name]
+* @endcode
+*/
+typedef struct {
+	unsigned long long sectors; /*!< Disk size in sectors, 0 to use the size of each image */
+	unsigned int num_partition_entries; /*!< Entries in the partition entry array */
+	int has_disk_guid; /*!< 1 if disk_guid is fixed by the spec */
+	guid disk_guid; /*!< Disk GUID */
+	unsigned int count; /*!< Number of partitions */
+	gpt_partition_descriptor * partitions; /*!< Partitions, ending_lba = 0 means "last usable LBA" */
+} gpt_spec;
+
+/**
+* @brief Reads a layout specification file
+* @param filename Spec filename
+* @param spec Spec to fill
+* @return 1 on success, 0 on failure
+*/
+int parse_gpt_spec(char * filename, gpt_spec * spec);
+
+/**
+* @brief Releases the partitions of a spec
+* @param spec Spec
+*/
+void free_gpt_spec(gpt_spec * spec);
+
+/**
+* @brief Writes the protective MBR, both GPT headers and both entry arrays to an image
+* @param path Image or device filename (created if it does not exist)
+* @param spec Layout specification
+* @return 1 on success, 0 on failure
+*/
+int write_gpt_image(char * path, gpt_spec * spec);
+
+/**
+* @brief Writes the same layout to several images concurrently
+* @param paths Image filenames
+* @param n Number of images
+* @param spec Layout specification
+* @param jobs Number of threads (0 = number of online CPUs)
+* @return Number of images that could not be written
+*/
+int write_gpt_images(char ** paths, int n, gpt_spec * spec, int jobs);
+
+#endif
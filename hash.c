@@ -0,0 +1,163 @@
+/**
+ * @file hash.c
+ * @brief Implementaciones de la huella del contenido de las particiones
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "hash.h"
+#include "extent.h"
+#include "disk.h"
+
+/**
+* @brief Shared state of the hashing threads
+*/
+typedef struct {
+	int fd; /*!< Open disk */
+	unsigned long long offset; /*!< Offset of the first byte of the range */
+	unsigned long long size; /*!< Size of the range in bytes */
+	unsigned long long chunks; /*!< Number of chunks */
+	unsigned long long next; /*!< Next chunk to read */
+	unsigned char * digests; /*!< Digest of each chunk */
+	int failed; /*!< 1 if a read failed */
+} hash_job;
+
+/**
+* @brief Hashing thread: reads and hashes the next pending chunk until there are none left
+*/
+static void * hash_worker(void * arg) {
+	hash_job * job = (hash_job *)arg;
+	unsigned long long i;
+	unsigned char * buf = (unsigned char *)malloc(HASH_CHUNK_SIZE);
+	int failed = 0;
+	if (buf == NULL) {
+		__atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+	//Los hilos se detienen en cuanto alguno falla: failed se lee y escribe de forma atómica
+	while (!__atomic_load_n(&job->failed, __ATOMIC_RELAXED) && (i = __sync_fetch_and_add(&job->next, 1)) < job->chunks) {
+		unsigned long long offset = i * HASH_CHUNK_SIZE;
+		size_t size = (job->size - offset < HASH_CHUNK_SIZE) ? job->size - offset : HASH_CHUNK_SIZE;
+		size_t done = 0;
+		while (done < size) {
+			ssize_t n = pread(job->fd, buf + done, size - done, job->offset + offset + done);
+			if (n <= 0) {
+				failed = 1;
+				__atomic_store_n(&job->failed, 1, __ATOMIC_RELAXED);
+				break;
+			}
+			done += n;
+		}
+		if (failed) break;
+		sha256_ctx ctx;
+		sha256_init(&ctx);
+		sha256_update(&ctx, buf, size);
+		sha256_final(&ctx, job->digests + i * SHA256_DIGEST_SIZE);
+	}
+	free(buf);
+	return NULL;
+}
+
+int hash_sectors(char * disk, unsigned long long start, unsigned long long end, int threads,
+		unsigned char digest[SHA256_DIGEST_SIZE]) {
+	hash_job job;
+	pthread_t * ids;
+	int started = 0;
+
+	memset(&job, 0, sizeof(job));
+	job.fd = open(disk, O_RDONLY);
+	if (job.fd < 0) return 0;
+	job.offset = start * SECTOR_SIZE;
+	job.size = (end - start + 1) * SECTOR_SIZE;
+	job.chunks = (job.size + HASH_CHUNK_SIZE - 1) / HASH_CHUNK_SIZE;
+	job.digests = (unsigned char *)malloc(job.chunks * SHA256_DIGEST_SIZE);
+	if (job.digests == NULL) {
+		close(job.fd);
+		return 0;
+	}
+	//1. Los hilos leen y resumen fragmentos independientes del rango
+	if (threads <= 0) threads = sysconf(_SC_NPROCESSORS_ONLN);
+	if ((unsigned long long)threads > job.chunks) threads = job.chunks;
+	ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+	if (ids != NULL) {
+		for (; started < threads; started++) {
+			if (pthread_create(&ids[started], NULL, hash_worker, &job) != 0) break;
+		}
+	}
+	if (started == 0) hash_worker(&job);
+	for (int i = 0; i < started; i++) {
+		pthread_join(ids[i], NULL);
+	}
+	free(ids);
+	close(job.fd);
+	//2. La raíz es el SHA-256 de los resúmenes de los fragmentos, en orden
+	if (!job.failed) {
+		sha256_ctx ctx;
+		sha256_init(&ctx);
+		sha256_update(&ctx, job.digests, job.chunks * SHA256_DIGEST_SIZE);
+		sha256_final(&ctx, digest);
+	}
+	free(job.digests);
+	return !job.failed;
+}
+
+/**
+* @brief Checks if a partition number is in a comma-separated list
+*/
+static int in_list(char * list, unsigned int number) {
+	char * ptr = list;
+	while (ptr != NULL && *ptr != 0) {
+		char * end;
+		unsigned long value = strtoul(ptr, &end, 10);
+		if (end != ptr && value == number) return 1;
+		ptr = strchr(ptr, ',');
+		if (ptr != NULL) ptr++;
+	}
+	return 0;
+}
+
+int hash_partitions(char * disk, int threads, char * skip) {
+	extent_index index;
+	unsigned char digest[SHA256_DIGEST_SIZE];
+	int status = EXIT_SUCCESS;
+
+	if (!build_extent_index(disk, &index)) {
+		fprintf(stderr, "Unable to read partition table of %s\n", disk);
+		return EXIT_FAILURE;
+	}
+	unsigned long long sectors = disk_size_sectors(disk);
+	printf("#\tStart LBA\tEnd LBA\t\tSHA-256 tree hash\n");
+	for (unsigned int i = 0; i < index.count; i++) {
+		if (in_list(skip, index.numbers[i])) {
+			printf("%u\t%llu\t\t%llu\t\tskipped\n", index.numbers[i], index.starts[i], index.ends[i]);
+			continue;
+		}
+		//Una entrada corrupta (fin antes del inicio o fuera del disco) se reporta como un error de lectura
+		if (index.ends[i] < index.starts[i] || index.ends[i] >= sectors) {
+			printf("%u\t%llu\t\t%llu\t\tinvalid range\n", index.numbers[i], index.starts[i], index.ends[i]);
+			status = EXIT_FAILURE;
+			continue;
+		}
+		if (!hash_sectors(disk, index.starts[i], index.ends[i], threads, digest)) {
+			printf("%u\t%llu\t\t%llu\t\tread error\n", index.numbers[i], index.starts[i], index.ends[i]);
+			status = EXIT_FAILURE;
+			continue;
+		}
+		printf("%u\t%llu\t\t%llu\t\t", index.numbers[i], index.starts[i], index.ends[i]);
+		for (int j = 0; j < SHA256_DIGEST_SIZE; j++) {
+			printf("%02x", digest[j]);
+		}
+		printf("\n");
+		fflush(stdout);
+	}
+	free_extent_index(&index);
+	return status;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file hash.h
+ * @brief Huella del contenido de cada partición con hash en árbol
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef HASH_H
+#define HASH_H
+
+#include "sha256.h"
+
+/** @brief Size of the chunks hashed independently, in bytes */
+#define HASH_CHUNK_SIZE (4 * 1024 * 1024)
+
+/**
+* @brief Computes the tree hash of a range of sectors
+*
+* The range is split in HASH_CHUNK_SIZE chunks that are read and hashed with
+* SHA-256 by several threads; the result is the SHA-256 of the concatenated
+* chunk digests, in order.
+* @param disk Disk filename
+* @param start First sector
+* @param end Last sector
+* @param threads Number of reads in flight (0 = number of online CPUs)
+* @param digest Result
+* @return 1 on success, 0 on failure
+*/
+int hash_sectors(char * disk, unsigned long long start, unsigned long long end, int threads,
+	unsigned char digest[SHA256_DIGEST_SIZE]);
+
+/**
+* @brief Hashes the contents of every partition of a disk and prints the results
+* @param disk Disk filename
+* @param threads Number of reads in flight (0 = number of online CPUs)
+* @param skip Comma-separated partition numbers that are not hashed (NULL for none)
+* @return Exit status
+*/
+int hash_partitions(char * disk, int threads, char * skip);
+
+#endif
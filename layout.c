@@ -0,0 +1,204 @@
+/**
+ * @file layout.c
+ * @brief Implementaciones para la huella canónica del esquema de particiones
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "layout.h"
+#include "disk.h"
+
+/** @brief FNV-1a 64-bit offset basis */
+#define FNV_OFFSET_BASIS 0xcbf29ce484222325ULL
+
+/** @brief FNV-1a 64-bit prime */
+#define FNV_PRIME 0x100000001b3ULL
+
+/**
+* @brief Compares two entries by (type, start, end, attributes)
+*/
+static int compare_entries(const void * a, const void * b) {
+	const layout_entry * x = (const layout_entry *)a;
+	const layout_entry * y = (const layout_entry *)b;
+	int r = memcmp(x->type_guid, y->type_guid, 16);
+	if (r != 0) return r;
+	if (x->starting_lba != y->starting_lba) return x->starting_lba < y->starting_lba ? -1 : 1;
+	if (x->ending_lba != y->ending_lba) return x->ending_lba < y->ending_lba ? -1 : 1;
+	if (x->attributes != y->attributes) return x->attributes < y->attributes ? -1 : 1;
+	return 0;
+}
+
+/**
+* @brief Adds a buffer to a FNV-1a hash
+*/
+static unsigned long long fnv1a(unsigned long long h, const unsigned char * buf, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		h ^= buf[i];
+		h *= FNV_PRIME;
+	}
+	return h;
+}
+
+/**
+* @brief Adds a 64-bit value to a FNV-1a hash, byte by byte in little-endian order
+*/
+static unsigned long long fnv1a_u64(unsigned long long h, unsigned long long value) {
+	unsigned char bytes[8];
+	for (int i = 0; i < 8; i++) {
+		bytes[i] = (value >> (i * 8)) & 0xff;
+	}
+	return fnv1a(h, bytes, 8);
+}
+
+unsigned long long layout_fingerprint(int scheme, layout_entry * entries, int count) {
+	unsigned long long h = FNV_OFFSET_BASIS;
+	//El esquema forma parte de la huella: un MBR y un GPT nunca son iguales
+	h = fnv1a_u64(h, scheme);
+	for (int i = 0; i < count; i++) {
+		h = fnv1a(h, entries[i].type_guid, 16);
+		h = fnv1a_u64(h, entries[i].starting_lba);
+		h = fnv1a_u64(h, entries[i].ending_lba);
+		h = fnv1a_u64(h, entries[i].attributes);
+	}
+	return h;
+}
+
+/**
+* @brief Adds an entry to the layout, growing the array if needed
+* @return 1 on success, 0 on failure
+*/
+static int add_entry(disk_layout * layout, int * capacity, layout_entry * entry) {
+	if (layout->count == *capacity) {
+		int new_capacity = (*capacity == 0) ? 8 : *capacity * 2;
+		layout_entry * ptr = (layout_entry *)realloc(layout->entries, new_capacity * sizeof(layout_entry));
+		if (ptr == NULL) {
+			return 0;
+		}
+		layout->entries = ptr;
+		*capacity = new_capacity;
+	}
+	layout->entries[layout->count++] = *entry;
+	return 1;
+}
+
+/**
+* @brief State used to build a layout from the GPT entry array
+*/
+typedef struct {
+	disk_layout * layout; /*!< Layout being built */
+	int * capacity; /*!< Capacity of the entries array */
+} layout_builder;
+
+/**
+* @brief Adds a non-null GPT descriptor to a layout (gpt_entry_callback)
+*/
+static int add_gpt_entry(gpt_partition_descriptor * desc, unsigned int index, void * arg) {
+	layout_builder * builder = (layout_builder *)arg;
+	layout_entry entry;
+	if (is_null_descriptor(desc)) return 1;
+	memcpy(entry.type_guid, desc->partition_type_guid, 16);
+	entry.starting_lba = desc->starting_lba;
+	entry.ending_lba = desc->ending_lba;
+	entry.attributes = desc->attributes;
+	return add_entry(builder->layout, builder->capacity, &entry);
+}
+
+int load_disk_layout(char * disk, disk_layout * layout) {
+	mbr boot_record;
+	gpt_header hdr;
+	layout_entry entry;
+	int capacity = 0;
+
+	memset(layout, 0, sizeof(disk_layout));
+	layout->disk = disk;
+	//1. Leer el primer sector del disco
+	if (read_lba_sector(disk, 0, (char *)&boot_record) == 0) {
+		return 0;
+	}
+	if (is_mbr(&boot_record)) {
+		//2. Esquema MBR: las entradas salen de la tabla de particiones del MBR
+		layout->scheme = LAYOUT_SCHEME_MBR;
+		for (int i = 0; i < 4; i++) {
+			mbr_partition_descriptor * desc = &boot_record.partition_table[i];
+			if (desc->partition_type == MBR_TYPE_UNUSED) continue;
+			memset(&entry, 0, sizeof(entry));
+			entry.type_guid[0] = desc->partition_type;
+			entry.starting_lba = desc->starting_sector_lba;
+			entry.ending_lba = (unsigned long long)desc->starting_sector_lba + desc->sectors_in_partition - 1;
+			entry.attributes = desc->boot_flag;
+			if (!add_entry(layout, &capacity, &entry)) {
+				free_disk_layout(layout);
+				return 0;
+			}
+		}
+	} else {
+		//3. Esquema GPT: leer el encabezado y el arreglo de descriptores
+		layout->scheme = LAYOUT_SCHEME_GPT;
+		if (read_lba_sector(disk, 1, (char *)&hdr) == 0 || !is_valid_gpt_header(&hdr)) {
+			return 0;
+		}
+		layout_builder builder = {layout, &capacity};
+		if (gpt_read_entries(disk, &hdr, add_gpt_entry, &builder) != GPT_ENTRIES_OK) {
+			free_disk_layout(layout);
+			return 0;
+		}
+	}
+	//4. Ordenar las entradas para que la huella no dependa de la posición en la tabla
+	qsort(layout->entries, layout->count, sizeof(layout_entry), compare_entries);
+	layout->fingerprint = layout_fingerprint(layout->scheme, layout->entries, layout->count);
+	return 1;
+}
+
+void free_disk_layout(disk_layout * layout) {
+	free(layout->entries);
+	layout->entries = NULL;
+	layout->count = 0;
+}
+
+/**
+* @brief Compares two layouts by fingerprint
+*/
+static int compare_fingerprints(const void * a, const void * b) {
+	const disk_layout * x = *(const disk_layout * const *)a;
+	const disk_layout * y = *(const disk_layout * const *)b;
+	if (x->fingerprint != y->fingerprint) return x->fingerprint < y->fingerprint ? -1 : 1;
+	return 0;
+}
+
+int print_layout_outliers(disk_layout * layouts, int n) {
+	int outliers = 0;
+	if (n == 0) return 0;
+	//1. Ordenar los discos por huella para agruparlos
+	disk_layout ** sorted = (disk_layout **)malloc(n * sizeof(disk_layout *));
+	if (sorted == NULL) return 0;
+	for (int i = 0; i < n; i++) {
+		sorted[i] = &layouts[i];
+	}
+	qsort(sorted, n, sizeof(disk_layout *), compare_fingerprints);
+	//2. La huella de referencia es la del grupo más grande
+	unsigned long long reference = sorted[0]->fingerprint;
+	int best = 0;
+	for (int i = 0; i < n; ) {
+		int j = i;
+		while (j < n && sorted[j]->fingerprint == sorted[i]->fingerprint) j++;
+		if (j - i > best) {
+			best = j - i;
+			reference = sorted[i]->fingerprint;
+		}
+		i = j;
+	}
+	printf("Reference fingerprint: %016llx (%d of %d disks)\n", reference, best, n);
+	//3. Imprimir solo los discos cuya huella difiere de la referencia, en el orden original
+	for (int i = 0; i < n; i++) {
+		if (layouts[i].fingerprint == reference) continue;
+		printf("%016llx\t%s\t(%d partitions)\n", layouts[i].fingerprint, layouts[i].disk, layouts[i].count);
+		outliers++;
+	}
+	free(sorted);
+	return outliers;
+}
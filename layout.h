@@ -0,0 +1,74 @@
+/**
+ * @file layout.h
+ * @brief Huella (fingerprint) canónica del esquema de particiones de un disco
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef LAYOUT_H
+#define LAYOUT_H
+
+#include "mbr.h"
+#include "gpt.h"
+
+/** @brief Partitioning scheme: MBR */
+#define LAYOUT_SCHEME_MBR 1
+
+/** @brief Partitioning scheme: GPT */
+#define LAYOUT_SCHEME_GPT 2
+
+/**
+* @brief Canonical partition entry, common to MBR and GPT descriptors
+*/
+typedef struct {
+	unsigned char type_guid[16]; /*!< Type GUID (GPT) or type byte in type_guid[0] (MBR) */
+	unsigned long long starting_lba; /*!< Starting LBA */
+	unsigned long long ending_lba; /*!< Ending LBA */
+	unsigned long long attributes; /*!< GPT attributes or MBR boot flag */
+} layout_entry;
+
+/**
+* @brief Partition layout of a disk
+*/
+typedef struct {
+	char * disk; /*!< Disk filename */
+	int scheme; /*!< LAYOUT_SCHEME_MBR or LAYOUT_SCHEME_GPT */
+	int count; /*!< Number of used entries */
+	layout_entry * entries; /*!< Used entries, sorted by (type, start, end, attributes) */
+	unsigned long long fingerprint; /*!< Hash of the sorted entries */
+} disk_layout;
+
+/**
+* @brief Reads the partition table of a disk and computes its fingerprint
+* @param disk Disk filename
+* @param layout Layout to fill
+* @return 1 on success, 0 on failure
+*/
+int load_disk_layout(char * disk, disk_layout * layout);
+
+/**
+* @brief Releases the entries of a layout
+* @param layout Layout
+*/
+void free_disk_layout(disk_layout * layout);
+
+/**
+* @brief Computes the fingerprint of a list of sorted entries (FNV-1a, 64 bits)
+* @param scheme Partitioning scheme
+* @param entries Sorted entries
+* @param count Number of entries
+* @return Fingerprint of the layout
+*/
+unsigned long long layout_fingerprint(int scheme, layout_entry * entries, int count);
+
+/**
+* @brief Groups the layouts by fingerprint and prints the disks that differ from the largest group
+* @param layouts Array of layouts
+* @param n Number of layouts
+* @return Number of outlier disks
+*/
+int print_layout_outliers(disk_layout * layouts, int n);
+
+#endif
@@ -7,41 +7,31 @@
  * @copyright MIT License
 */
 #include <fcntl.h>
-#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <ctype.h>
+#include <getopt.h>
 
 #include "mbr.h"
 #include "gpt.h"
-
-/** @brief Sector size */
-#define SECTOR_SIZE 512
-
-/**
-* @brief Hex dumps a buffer
-* @param buf Pointer to buffer
-* @param size Buffer size
-*/
-void hex_dump(char * buf, size_t size);
-
-/**
-* @brief ASCII dumps a buffer
-* @param buf Pointer to buffer
-* @param size Buffer size
-*/
-void ascii_dump(char * buf, size_t size);
-/**
- * @brief Read a sector from a disk
- * 
- * @param disk Disk filename
- * @param lba Sector to read (0 - amount of LBA sectors on disk)
- * @param buf Buffer to read the sector info
- * @return int 1 on success, 0 on failure
- */
-int read_lba_sector(char * disk, unsigned long long lba, char buf[512]);
+#include "disk.h"
+#include "layout.h"
+#include "gptwrite.h"
+#include "server.h"
+#include "extent.h"
+#include "hash.h"
+#include "dump.h"
+#include "export.h"
+#include "fields.h"
+#include "filter.h"
+#include "bench.h"
+#include "typedb.h"
+#include "alias.h"
+#include "sched.h"
+#include "snapshot.h"
+#include "repair.h"
 
 /**
  * @brief Prints the partition table of a MBR
@@ -76,21 +66,370 @@ void titlesTable();
  */
 void to_upper(char *str);
 
-int num_sectors=0; /*Cantidad de sectores de la tabla (cantidad de entradas x tamaño de cada entrada)/tamaño sector*/
+/**
+ * @brief Prints the command line usage
+ * 
+ * @param prog Program name
+ */
+void usage(char * prog);
+
+/**
+ * @brief Prints the layout fingerprint of each disk, or only the outliers
+ * 
+ * @param disks Disk filenames
+ * @param n Number of disks
+ * @param source Disk read for each disk (see alias_sources), NULL to read all of them
+ * @param diff 1 to print only the disks that differ from the largest group
+ * @param threads Disks read concurrently (0: as many as the controller slots, see sched_scan)
+ * @return int Exit status
+ */
+int fingerprint_disks(char ** disks, int n, const int * source, int diff, int threads);
+
+/**
+ * @brief Resolves a list of LBAs to the partitions of a disk
+ * 
+ * @param disk Disk filename
+ * @param filename File with one LBA per line, "-" for stdin
+ * @param unit Size of the LBAs in bytes (512 or 4096)
+ * @return int EXIT_SUCCESS if every LBA resolved to a partition, EXIT_FAILURE otherwise
+ */
+int lookup_disk(char * disk, char * filename, unsigned int unit);
+
+/**
+ * @brief Prints a GPT partition descriptor if it is not null
+ * 
+ * @param desc GPT partition descriptor
+ * @param index Index of the descriptor in the entry array
+ * @param arg Not used
+ * @return int 1 to continue with the next descriptor
+ */
+int print_entry(gpt_partition_descriptor * desc, unsigned int index, void * arg);
+
+filter_program * where = NULL; /*Filtro de --where (NULL si no se especificó)*/
 
 int main(int argc, char *argv[]) {
 	int i;
 	char * disk;
+	int opt;
+	int fingerprint = 0;
+	int diff = 0;
+	char * spec_file = NULL;
+	int jobs = 0;
+	char * socket_path = NULL;
+	char * lookup_file = NULL;
+	unsigned int unit = SECTOR_SIZE;
+	int hash = 0;
+	char * hash_skip = NULL;
+	char * dump = NULL;
+	char * prom_file = NULL;
+	int interval = 0;
+	char * field_names = NULL;
+	filter_program program = {0};
+	int bench = 0;
+	int dedup = 0;
+	char * snapshot_file = NULL;
+	int query = 0;
+	int repair = 0;
+	int dry_run = 0;
+	disk_group * groups;
+	int num_groups;
+	bench_options bench_opts = {BENCH_SEQ_BLOCK, BENCH_RAND_BLOCK, BENCH_SAMPLE, 0};
+	static struct option long_options[] = {
+		{"fingerprint", no_argument, 0, 'f'},
+		{"diff", no_argument, 0, 'd'},
+		{"write", required_argument, 0, 'w'},
+		{"jobs", required_argument, 0, 'j'},
+		{"window", required_argument, 0, 'W'},
+		{"serve", required_argument, 0, 'S'},
+		{"lookup", required_argument, 0, 'l'},
+		{"unit", required_argument, 0, 'u'},
+		{"hash", no_argument, 0, 'H'},
+		{"hash-skip", required_argument, 0, 'k'},
+		{"record", required_argument, 0, 'r'},
+		{"replay", required_argument, 0, 'R'},
+		{"dump", required_argument, 0, 'x'},
+		{"prom", required_argument, 0, 'p'},
+		{"interval", required_argument, 0, 'i'},
+		{"fields", required_argument, 0, 'o'},
+		{"where", required_argument, 0, 'e'},
+		{"bench-read", no_argument, 0, 'B'},
+		{"block-size", required_argument, 0, 'b'},
+		{"sample", required_argument, 0, 's'},
+		{"types-db", required_argument, 0, 't'},
+		{"dedup", no_argument, 0, 'D'},
+		{"queue-depth", required_argument, 0, 'q'},
+		{"snapshot", required_argument, 0, 'c'},
+		{"query", required_argument, 0, 'Q'},
+		{"repair", no_argument, 0, 'F'},
+		{"dry-run", no_argument, 0, 'n'},
+		{0, 0, 0, 0}
+	};
 	//1. Validar los argumentos de la linea de comandos
-	if(argc<2){
-		fprintf(stderr,"Usage: %s disk1 [disk2 ...]\n",argv[0]);
+	while((opt = getopt_long(argc, argv, "fdw:j:W:S:l:u:Hk:r:R:x:p:i:o:e:Bb:s:t:Dq:c:Q:Fn", long_options, NULL)) != -1){
+		switch(opt){
+			case 'f':
+				fingerprint = 1;
+				break;
+			case 'd':
+				diff = 1;
+				break;
+			case 'w':
+				spec_file = optarg;
+				break;
+			case 'j':
+				jobs = atoi(optarg);
+				break;
+			case 'W':{
+				//La ventana no necesita ser mayor que el arreglo más grande que se acepta
+				char * end;
+				unsigned long window = strtoul(optarg, &end, 0);
+				if(*optarg == '\0' || *end != '\0' || optarg[0] == '-' || window == 0 || window > GPT_MAX_ARRAY_SIZE / SECTOR_SIZE){
+					fprintf(stderr,"Window must be between 1 and %d sectors\n",GPT_MAX_ARRAY_SIZE / SECTOR_SIZE);
+					exit(EXIT_FAILURE);
+				}
+				gpt_window_sectors = window;
+				break;
+			}
+			case 'S':
+				socket_path = optarg;
+				break;
+			case 'l':
+				lookup_file = optarg;
+				break;
+			case 'u':
+				unit = atoi(optarg);
+				if(unit != 512 && unit != 4096){
+					fprintf(stderr,"Unit must be 512 or 4096\n");
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'H':
+				hash = 1;
+				break;
+			case 'k':
+				hash_skip = optarg;
+				break;
+			case 'x':
+				dump = optarg;
+				break;
+			case 'p':
+				prom_file = optarg;
+				break;
+			case 'i':
+				interval = atoi(optarg);
+				break;
+			case 'o':
+				field_names = optarg;
+				break;
+			case 'e':
+				//Varias opciones --where se combinan con Y lógico
+				if(!compile_filter(optarg, &program)){
+					exit(EXIT_FAILURE);
+				}
+				where = &program;
+				break;
+			case 'B':
+				bench = 1;
+				break;
+			case 'b':
+				if(!parse_bench_blocks(optarg, &bench_opts)){
+					fprintf(stderr,"Block sizes must be multiples of %d\n",BENCH_ALIGN);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 's':
+				bench_opts.sample = atof(optarg);
+				if(bench_opts.sample <= 0 || bench_opts.sample > 1){
+					fprintf(stderr,"Sample must be in (0, 1]\n");
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 't':
+				typedb_path = optarg;
+				break;
+			case 'D':
+				dedup = 1;
+				break;
+			case 'F':
+				repair = 1;
+				break;
+			case 'n':
+				dry_run = 1;
+				break;
+			case 'c':
+				snapshot_file = optarg;
+				break;
+			case 'Q':
+				query = parse_snapshot_query(optarg);
+				if(query == 0){
+					fprintf(stderr,"Unknown query %s (types, sizes or summary)\n",optarg);
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'q':
+				if(!parse_sched_depth(optarg, &sched_depth)){
+					fprintf(stderr,"Queue depth must be a positive number\n");
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case 'r':
+				if(!disk_record(optarg)){
+					fprintf(stderr,"Unable to create trace %s\n",optarg);
+					exit(EXIT_FAILURE);
+				}
+				atexit(disk_close_trace);
+				break;
+			case 'R':
+				if(!disk_replay(optarg)){
+					fprintf(stderr,"Unable to load trace %s\n",optarg);
+					exit(EXIT_FAILURE);
+				}
+				atexit(disk_close_trace);
+				break;
+			default:
+				usage(argv[0]);
+				exit(EXIT_FAILURE);
+		}
+	}
+	if(optind>=argc){
+		usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	//1.0 Una base de datos de tipos dada con --types-db debe poder cargarse
+	if(typedb_path != NULL && !typedb_load()){
+		exit(EXIT_FAILURE);
+	}
+	//1.0.1 --where solo filtra el listado y --fields
+	if(where != NULL && (query != 0 || fingerprint || diff || repair || socket_path != NULL || (field_names == NULL &&
+			(snapshot_file != NULL || prom_file != NULL || dump != NULL || bench || hash || lookup_file != NULL || spec_file != NULL)))){
+		fprintf(stderr,"--where only applies to the listing and --fields\n");
+		exit(EXIT_FAILURE);
+	}
+	//1.1 Modos alternativos al listado de particiones
+	if(query != 0){
+		//Con --query, los argumentos son instantáneas y no discos
+		return query_snapshots(query, &argv[optind], argc - optind);
+	}
+	//1.2 --dedup solo se aplica a los modos que recorren varios discos
+	if(dedup && (repair || socket_path != NULL || dump != NULL || bench || hash || lookup_file != NULL || spec_file != NULL)){
+		fprintf(stderr,"--dedup only applies to the listing, --fields, --fingerprint, --prom and --snapshot\n");
+		exit(EXIT_FAILURE);
+	}
+	//1.3 En los recorridos de la flota, con --dedup se lee un solo alias de cada disco físico
+	int * source = NULL;
+	if(dedup && (fingerprint || diff || snapshot_file != NULL || prom_file != NULL) &&
+			!alias_sources(&argv[optind], argc - optind, &source)){
+		fprintf(stderr,"Out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	if(fingerprint || diff){
+		int status = fingerprint_disks(&argv[optind], argc - optind, source, diff, jobs);
+		free(source);
+		return status;
+	}
+	if(repair){
+		int status = EXIT_SUCCESS;
+		for(i = optind; i < argc; i++){
+			if(repair_gpt(argv[i], dry_run) != EXIT_SUCCESS) status = EXIT_FAILURE;
+		}
+		return status;
+	}
+	if(socket_path != NULL){
+		return run_server(socket_path, &argv[optind], argc - optind);
+	}
+	if(field_names != NULL){
+		field_list fields;
+		int status = EXIT_SUCCESS;
+		if(!parse_fields(field_names, &fields)){
+			exit(EXIT_FAILURE);
+		}
+		//Con --dedup, los alias de un mismo disco se leen una sola vez
+		num_groups = dedup ? group_disk_aliases(&argv[optind], argc - optind, &groups) : single_disk_groups(&argv[optind], argc - optind, &groups);
+		if(num_groups < 0){
+			fprintf(stderr,"Out of memory\n");
+			exit(EXIT_FAILURE);
+		}
+		print_field_titles(&fields);
+		for(i = 0; i < num_groups; i++){
+			if(!list_fields(groups[i].disks, groups[i].count, &fields, where)){
+				fprintf(stderr,"Unable to read partition table of %s\n",groups[i].disks[0]);
+				status = EXIT_FAILURE;
+			}
+		}
+		free_disk_groups(groups, num_groups);
+		return status;
+	}
+	if(snapshot_file != NULL){
+		int skipped = write_snapshot(snapshot_file, &argv[optind], argc - optind, source, jobs);
+		if(skipped < 0){
+			fprintf(stderr,"Unable to write %s\n",snapshot_file);
+		}
+		free(source);
+		return skipped == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if(prom_file != NULL){
+		//Con --interval, el archivo se regenera periódicamente hasta que el proceso termina
+		int status = EXIT_SUCCESS;
+		do{
+			if(!export_metrics(prom_file, &argv[optind], argc - optind, source, jobs)){
+				fprintf(stderr,"Unable to write %s\n",prom_file);
+				if(interval <= 0) status = EXIT_FAILURE;
+			}
+			if(interval > 0) sleep(interval);
+		}while(interval > 0);
+		free(source);
+		return status;
+	}
+	if(dump != NULL){
+		int status = EXIT_SUCCESS;
+		for(i = optind; i < argc; i++){
+			if(dump_range(argv[i], dump) != EXIT_SUCCESS) status = EXIT_FAILURE;
+		}
+		return status;
+	}
+	if(bench){
+		int status = EXIT_SUCCESS;
+		bench_opts.queue_depth = jobs;
+		for(i = optind; i < argc; i++){
+			if(bench_partitions(argv[i], &bench_opts) != EXIT_SUCCESS) status = EXIT_FAILURE;
+		}
+		return status;
+	}
+	if(hash){
+		int status = EXIT_SUCCESS;
+		for(i = optind; i < argc; i++){
+			if(hash_partitions(argv[i], jobs, hash_skip) != EXIT_SUCCESS) status = EXIT_FAILURE;
+		}
+		return status;
+	}
+	if(lookup_file != NULL){
+		if(argc - optind > 1){
+			fprintf(stderr,"--lookup takes a single disk\n");
+			exit(EXIT_FAILURE);
+		}
+		return lookup_disk(argv[optind], lookup_file, unit);
+	}
+	if(spec_file != NULL){
+		gpt_spec spec;
+		if(!parse_gpt_spec(spec_file, &spec)){
+			exit(EXIT_FAILURE);
+		}
+		int failures = write_gpt_images(&argv[optind], argc - optind, &spec, jobs);
+		free_gpt_spec(&spec);
+		return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	//1.4 Con --dedup, los alias de un mismo disco se leen una sola vez
+	num_groups = dedup ? group_disk_aliases(&argv[optind], argc - optind, &groups) : single_disk_groups(&argv[optind], argc - optind, &groups);
+	if(num_groups < 0){
+		fprintf(stderr,"Out of memory\n");
 		exit(EXIT_FAILURE);
 	}
-	//2.Iterar sobre los discos especificados	
-	for(i =1; i<argc; i++){
+	//2.Iterar sobre los discos especificados (un alias por disco físico)
+	for(i = 0; i < num_groups; i++){
 		//3. Leer el primer sector del disco especificado
 		mbr boot_record;
-		disk = argv[i];
+		disk = groups[i].disks[0];
+		print_disk_aliases(&groups[i]);
 		//3.1. Si la lectura falla, mostrar un mensaje de error y terminar
 		if(read_lba_sector(disk,0,(char*)&boot_record)==0){
 			fprintf(stderr,"Unable to open device\n");
@@ -117,75 +456,31 @@ int main(int argc, char *argv[]) {
 			fprintf(stderr,"Invalid GPT Header\n");
 			exit(EXIT_FAILURE);
 		}
-		//Cantidad de sectores de la tabla de particiones
-		num_sectors = ceil((hdr.num_partition_entries*hdr.size_partition_entry)/512.0);		
-		//7.2 Imprimir el header
+		//7.2 Validar que el arreglo de descriptores esté dentro de los límites
+		if(!gpt_entries_within_limits(&hdr)){
+			fprintf(stderr,"Partition entry array out of limits (%u entries of %u bytes)\n",hdr.num_partition_entries,hdr.size_partition_entry);
+			exit(EXIT_FAILURE);
+		}
+		//7.3 Imprimir el header
 		print_gpt_header(&hdr);
 		//8. Imprimir la tabla de particiones
-		gpt_partition_descriptor descriptors[4]; //4 descriptores por sector(suponiendo que el tamaño del descriptor es 128 bytes y el bloque de disco es de 512 bytes)
 		//Table titles
 		titlesTable();
-		//8.1 Leer los descriptores de las particiones
-		for(int i = 0; i < num_sectors; i++){			
-			//8.1.1 Leer los siguientes sectores de la tabla de particiones
-			if(read_lba_sector(disk,hdr.partition_entry_lba+i,(char*)&descriptors)==0){
-				fprintf(stderr,"Unable to read this sector\n");
-				exit(EXIT_FAILURE);
-			}			
-			//8.1.2 Para cada descriptor leído, imprimir su información	
-			for(int j = 0; j < 4; j++){
-				//Si el descriptor es nulo, no se imprime
-				if(is_null_descriptor(&descriptors[j])) continue;
-				print_partition_descriptor(&descriptors[j]);
-			}
+		//8.1 Leer los descriptores por ventanas e imprimir los que no son nulos
+		int status = gpt_read_entries(disk, &hdr, print_entry, NULL);
+		if(status == GPT_ENTRIES_READ_ERROR){
+			fprintf(stderr,"Unable to read this sector\n");
+			exit(EXIT_FAILURE);
+		}
+		if(status == GPT_ENTRIES_BAD_CRC){
+			fprintf(stderr,"Warning: partition entry array CRC32 mismatch\n");
 		}
 		printf("-------------	-------------   ------------  --------------------------------------    --------------------------------------------\n");				
 	}
+	free_disk_groups(groups, num_groups);
 	return 0;
 }
 
-int read_lba_sector(char * disk, unsigned long long lba, char buf[512]) {
-	FILE *fd;
-	//Abrir el archivo en modo lectura
-	fd = fopen(disk, "r");
-	if (fd == NULL) {	
-		printf("No se pudo abrir el archivo");
-		return 0;
-	}
-	//Avanzar el apuntador de lectura en el dispositivo
-	if(fseek(fd, lba * SECTOR_SIZE, SEEK_SET)!=0){
-		return 0;
-	}
-	//Leer el sector del disco
-	if(fread(buf, 1, SECTOR_SIZE, fd)!=SECTOR_SIZE){
-		return 0;
-	}	
-	//Cerrar el archivo
-	fclose(fd);
-	return 1;
-}
-
-void ascii_dump(char * buf, size_t size) {
-	for (size_t i = 0; i < size; i++) {
-		if (buf[i] >= 0x20 && buf[i] < 0x7F) {
-			printf("%c", buf[i]);
-		}else {
-			printf(".");
-		}
-	}
-}
-
-void hex_dump(char * buf, size_t size) {
-	int cols;
-	cols = 0;
-	for (size_t i=0; i < size; i++) {
-		printf("%02x ", buf[i] & 0xff);
-		if (++cols % 16 == 0) {
-			ascii_dump(&buf[cols - 16], 16);
-			printf("\n");
-		}
-	}
-}
 void print_partition_table(mbr * boot_record) {
 	char type_name[TYPE_NAME_LEN];
 	if(is_mbr(boot_record)==1){
@@ -201,6 +496,10 @@ void print_partition_table(mbr * boot_record) {
 		if (boot_record->partition_table[i].partition_type == MBR_TYPE_UNUSED) {
 			continue;
 		}
+		//Si hay filtro, solo se imprimen las particiones que lo cumplen
+		if (!filter_match_mbr(where, &boot_record->partition_table[i], i + 1)) {
+			continue;
+		}
 		//Se obtiene el nombre del tipo de partición
 		mbr_partition_type(boot_record->partition_table[i].partition_type, type_name);
 		//Se imprime la información de la partición
@@ -218,17 +517,14 @@ void print_gpt_header(gpt_header * hdr){
 	printf("Partition Entry LBA: %d\n",hdr->partition_entry_lba);
 	printf("Number of Partition Entries: %d\n",hdr->num_partition_entries);
 	printf("Size of Partition Entry: %d\n",hdr->size_partition_entry);
-	printf("Total of partition table entries sectors: %d\n",num_sectors);
+	printf("Total of partition table entries sectors: %llu\n",gpt_array_sectors(hdr));
 	printf("Size of a partition Descriptor: %d\n", hdr->size_partition_entry);	
 }
 void print_partition_descriptor(gpt_partition_descriptor * desc){	
-	//Se convierte el GUID a una cadena
-	char * guid_str = guid_to_str((guid*)&desc->partition_type_guid);	
 	//Tamaño en bytes de la partición
 	unsigned long long size = ((desc->ending_lba - desc->starting_lba)+1)*512; 		
 	//Se obtiene la información del tipo de partición a partir del GUID
-	to_upper(guid_str);
-	const gpt_partition_type * type = get_gpt_partition_type(guid_str);		
+	const gpt_partition_type * type = get_gpt_partition_type_guid(desc->partition_type_guid);
 	printf("    %d\t",desc->starting_lba);
 	printf("    %d\t",desc->ending_lba);
 	printf("  %d\t",size);
@@ -237,6 +533,14 @@ void print_partition_descriptor(gpt_partition_descriptor * desc){
 	printf("\n");
 }
 
+int print_entry(gpt_partition_descriptor * desc, unsigned int index, void * arg){
+	//Si el descriptor es nulo o no cumple el filtro, no se imprime
+	if(!is_null_descriptor(desc) && filter_match_gpt(where, desc, index + 1)){
+		print_partition_descriptor(desc);
+	}
+	return 1;
+}
+
 void titlesTable(){
 	printf("Start LBA\tEnd LBA\t\tSize\t\tType\t\t\t\t\tPartition name\n");
 	printf("-------------	-------------   ------------  --------------------------------------    --------------------------------------------\n");
@@ -246,4 +550,127 @@ void to_upper(char *str) {
         *str = toupper((unsigned char)*str);  // Convierte el carácter actual a mayúscula
         str++;  // Avanza al siguiente carácter
     }
-}
\ No newline at end of file
+}
+
+void usage(char * prog){
+	fprintf(stderr,"Usage: %s [options] disk1 [disk2 ...]\n",prog);
+	fprintf(stderr,"       %s --query KIND snapshot1 [snapshot2 ...]\n",prog);
+	fprintf(stderr,"Options:\n");
+	fprintf(stderr,"  -f, --fingerprint   Print the layout fingerprint of each disk\n");
+	fprintf(stderr,"  -d, --diff          Group disks by fingerprint and print only the outliers\n");
+	fprintf(stderr,"  -w, --write SPEC    Write the GPT layout described in SPEC to each disk image\n");
+	fprintf(stderr,"  -j, --jobs N        Number of images written concurrently (default: online CPUs)\n");
+	fprintf(stderr,"                      Also the number of reads in flight for --hash and --bench-read\n");
+	fprintf(stderr,"  -W, --window N      Sectors of the partition entry array read at once (default: %d)\n",GPT_DEFAULT_WINDOW);
+	fprintf(stderr,"  -S, --serve SOCKET  Answer partition queries on a Unix domain socket\n");
+	fprintf(stderr,"  -l, --lookup FILE   Print the partition of each LBA in FILE (- for stdin) on the first disk\n");
+	fprintf(stderr,"  -H, --hash          Print a SHA-256 tree hash of the contents of each partition\n");
+	fprintf(stderr,"  -k, --hash-skip L   Comma-separated partition numbers not hashed by --hash\n");
+	fprintf(stderr,"  -x, --dump RANGE    Hex dump LBA[:count] or a region: mbr, header, array, backup, backup-array\n");
+	fprintf(stderr,"  -o, --fields LIST   Print only these columns: disk,number,start,end,sectors,size,\n");
+	fprintf(stderr,"                      type,typeguid,guid,name,attrs\n");
+	fprintf(stderr,"  -e, --where EXPR    Only list partitions matching EXPR, e.g. type=esp, size>1G, name~boot,\n");
+	fprintf(stderr,"                      attr.required (comma-separated or repeated: all must match)\n");
+	fprintf(stderr,"  -p, --prom FILE     Write partition metrics to FILE in Prometheus text format\n");
+	fprintf(stderr,"  -i, --interval N    With --prom, rewrite FILE every N seconds\n");
+	fprintf(stderr,"  -c, --snapshot FILE Write the GPT entries of the disks to FILE as a columnar snapshot\n");
+	fprintf(stderr,"  -Q, --query KIND    Aggregate the snapshots given as arguments: types, sizes or summary\n");
+	fprintf(stderr,"  -F, --repair        Rebuild a damaged primary or backup GPT from the valid copy\n");
+	fprintf(stderr,"  -n, --dry-run       With --repair, print the differences without writing\n");
+	fprintf(stderr,"  -r, --record TRACE  Record every sector read in TRACE\n");
+	fprintf(stderr,"  -R, --replay TRACE  Serve sector reads from TRACE instead of the disks\n");
+	fprintf(stderr,"  -B, --bench-read    Measure sequential and random read throughput of each partition\n");
+	fprintf(stderr,"  -b, --block-size S[,R] Block sizes of sequential and random reads (default: 1M,4K)\n");
+	fprintf(stderr,"  -s, --sample F      Fraction of each partition read by --bench-read (default: %.2f)\n",BENCH_SAMPLE);
+	fprintf(stderr,"  -t, --types-db FILE Partition type database (default: $%s or %s)\n",TYPEDB_ENV,TYPEDB_DEFAULT_PATH);
+	fprintf(stderr,"  -q, --queue-depth N Reads in flight per controller when scanning many disks (default: %d)\n",SCHED_CONTROLLER_DEPTH);
+	fprintf(stderr,"  -D, --dedup         Read once the disks that are paths to the same LUN (multipath)\n");
+	fprintf(stderr,"  -u, --unit N        Size of the LBAs given to --lookup: 512 (default) or 4096\n");
+}
+
+/**
+ * @brief Layouts of the disks read by the scheduler
+ */
+typedef struct {
+	disk_layout * layouts; /*Esquema de cada disco*/
+	int * ok; /*1 para cada disco leído*/
+	const int * source; /*Disco leído en lugar de cada disco, NULL para leerlos todos*/
+} fingerprint_scan;
+
+/**
+ * @brief Reads the layout of a disk for fingerprint_disks (sched_task)
+ */
+static void fingerprint_task(char * disk, int index, void * arg){
+	fingerprint_scan * scan = (fingerprint_scan *)arg;
+	if(scan->source != NULL && scan->source[index] != index) return;
+	scan->ok[index] = load_disk_layout(disk, &scan->layouts[index]);
+}
+
+int fingerprint_disks(char ** disks, int n, const int * source, int diff, int threads){
+	int status = EXIT_SUCCESS;
+	disk_layout * layouts = (disk_layout *)calloc(n, sizeof(disk_layout));
+	disk_layout * rows = (disk_layout *)malloc((n > 0 ? n : 1) * sizeof(disk_layout));
+	int * ok = (int *)calloc(n, sizeof(int));
+	int loaded = 0;
+	if(layouts == NULL || rows == NULL || ok == NULL){
+		fprintf(stderr,"Out of memory\n");
+		free(layouts);
+		free(rows);
+		free(ok);
+		return EXIT_FAILURE;
+	}
+	//1. Leer el esquema de cada disco en paralelo y calcular su huella
+	fingerprint_scan scan = {layouts, ok, source};
+	sched_scan(disks, n, threads, fingerprint_task, &scan);
+	//1.1 Reunir los esquemas leídos en el orden de la línea de comandos; cada alias usa el de su disco leído
+	for(int i = 0; i < n; i++){
+		int read = (source != NULL) ? source[i] : i;
+		if(!ok[read]){
+			fprintf(stderr,"Unable to read partition table of %s\n",disks[i]);
+			status = EXIT_FAILURE;
+			continue;
+		}
+		if(!diff){
+			printf("%016llx\t%s\n",layouts[read].fingerprint,disks[i]);
+		}
+		rows[loaded] = layouts[read];
+		rows[loaded++].disk = disks[i];
+	}
+	free(ok);
+	//2. Agrupar por huella e imprimir solo los discos distintos a la referencia
+	if(diff && print_layout_outliers(rows, loaded) > 0){
+		status = EXIT_FAILURE;
+	}
+	//Las filas comparten las entradas de los esquemas, que se liberan una sola vez
+	for(int i = 0; i < n; i++){
+		free_disk_layout(&layouts[i]);
+	}
+	free(layouts);
+	free(rows);
+	return status;
+}
+
+int lookup_disk(char * disk, char * filename, unsigned int unit){
+	extent_index index;
+	FILE * in = stdin;
+	//1. Construir el índice de extensiones del disco una sola vez
+	if(!build_extent_index(disk, &index)){
+		fprintf(stderr,"Unable to read partition table of %s\n",disk);
+		return EXIT_FAILURE;
+	}
+	//2. Resolver todos los LBAs de la entrada contra el índice
+	if(strcmp(filename, "-") != 0){
+		in = fopen(filename, "r");
+		if(in == NULL){
+			fprintf(stderr,"Unable to open %s\n",filename);
+			free_extent_index(&index);
+			return EXIT_FAILURE;
+		}
+	}
+	unsigned long long misses = lookup_lbas(&index, in, unit);
+	if(in != stdin){
+		fclose(in);
+	}
+	free_extent_index(&index);
+	return (misses == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
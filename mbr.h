@@ -19,6 +19,18 @@
 /** @brief Unused partition table - MBR*/
 #define MBR_TYPE_UNUSED 0x00
 
+/** @brief Extended partition (CHS) - MBR */
+#define MBR_TYPE_EXTENDED 0x05
+
+/** @brief Extended partition (LBA) - MBR */
+#define MBR_TYPE_EXTENDED_LBA 0x0F
+
+/** @brief Linux extended partition - MBR */
+#define MBR_TYPE_EXTENDED_LINUX 0x85
+
+/** @brief Maximum number of logical partitions followed in an EBR chain */
+#define MBR_MAX_LOGICAL 128
+
 /** @brief Maximum text length for partition type */
 #define TYPE_NAME_LEN 256
 
@@ -49,6 +61,13 @@ typedef struct {
 */
 int is_mbr(mbr * boot_record);
 
+/**
+* @brief Checks if a partition type is an extended partition (container of EBRs)
+* @param type Partition type reported in MBR
+* @return 1 If the type is an extended partition, 0 otherwise.
+*/
+int is_extended_partition(unsigned char type);
+
 /**
 * @brief Text description of a MBR partition type
 * @param type Partition type reported in MBR
@@ -0,0 +1,300 @@
+/**
+ * @file mktypedb.c
+ * @brief Generador de la base de datos binaria de tipos de partición
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+ *
+ * Uso: mktypedb [-c] SALIDA [TIPOS...]
+ *
+ * Combina los archivos de tipos del usuario con las tablas de types.c y
+ * escribe la base de datos (o, con -c, un archivo C que la embebe en el
+ * ejecutable). Formato de cada línea de un archivo de tipos:
+ *
+ *   gpt|GUID|Sistema operativo|Descripción
+ *   mbr|0xNN|Descripción
+ *
+ * Las líneas vacías y las que inician con # se ignoran. Los tipos del usuario
+ * tienen prioridad sobre los de types.c.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "types.h"
+#include "typedb.h"
+
+/** @brief Maximum length of a line of a types file */
+#define LINE_LEN 1024
+
+/** @brief Maximum displacement tried for a bucket of the perfect hash */
+#define MAX_DISPLACEMENT 1000000
+
+/** @brief GPT type being built */
+typedef struct {
+	unsigned char guid[16]; /*!< Type GUID, in on-disk byte order */
+	unsigned int os; /*!< Operating system (string pool offset) */
+	unsigned int description; /*!< Description (string pool offset) */
+	unsigned int guid_str; /*!< Text GUID (string pool offset) */
+	unsigned int bucket; /*!< First-level bucket */
+}build_entry;
+
+/** @brief GPT types */
+static build_entry * entries = NULL;
+static unsigned int num_entries = 0;
+
+/** @brief String offset of each MBR type, 0 if it has not been defined */
+static unsigned int mbr_types[256];
+
+/** @brief String pool */
+static char * pool = NULL;
+static unsigned int pool_size = 0;
+
+/**
+* @brief Adds a string to the pool, reusing an identical string if present
+* @return Offset of the string in the pool
+*/
+static unsigned int add_string(const char * str) {
+	unsigned int len = strlen(str) + 1;
+	//1. Buscar una cadena idéntica ya almacenada
+	for (unsigned int offset = 0; offset < pool_size; offset += strlen(pool + offset) + 1) {
+		if (strcmp(pool + offset, str) == 0) return offset;
+	}
+	//2. Agregar la cadena al final del pool
+	pool = (char *)realloc(pool, pool_size + len);
+	memcpy(pool + pool_size, str, len);
+	pool_size += len;
+	return pool_size - len;
+}
+
+/**
+* @brief Adds a GPT type, unless its GUID was already added
+* @return 1 if the type was added, 0 if the GUID is not valid
+*/
+static int add_gpt_type(const char * guid_str, const char * os, const char * description) {
+	guid buf;
+	char upper[37];
+	if (!str_to_guid(guid_str, &buf)) return 0;
+	for (unsigned int i = 0; i < num_entries; i++) {
+		if (memcmp(entries[i].guid, &buf, 16) == 0) return 1;
+	}
+	for (int i = 0; i < 37; i++) {
+		upper[i] = (guid_str[i] >= 'a' && guid_str[i] <= 'z') ? guid_str[i] - 'a' + 'A' : guid_str[i];
+	}
+	entries = (build_entry *)realloc(entries, (num_entries + 1) * sizeof(build_entry));
+	build_entry * e = &entries[num_entries++];
+	memcpy(e->guid, &buf, 16);
+	e->os = add_string(os);
+	e->description = add_string(description);
+	e->guid_str = add_string(upper);
+	return 1;
+}
+
+/**
+* @brief Reads a user types file
+* @return 1 if the file was read, 0 otherwise
+*/
+static int read_types_file(const char * path) {
+	char line[LINE_LEN];
+	int number = 0;
+	FILE * fd = fopen(path, "r");
+	if (fd == NULL) {
+		fprintf(stderr, "Unable to open %s\n", path);
+		return 0;
+	}
+	while (fgets(line, sizeof(line), fd) != NULL) {
+		char * fields[4] = {line, NULL, NULL, NULL};
+		int count = 1;
+		number++;
+		line[strcspn(line, "\r\n")] = 0;
+		if (line[0] == 0 || line[0] == '#') continue;
+		//1. Separar los campos por '|'
+		for (char * p = line; *p && count < 4; p++) {
+			if (*p == '|') {
+				*p = 0;
+				fields[count++] = p + 1;
+			}
+		}
+		//2. Agregar el tipo según el esquema
+		if (strcmp(fields[0], "gpt") == 0 && count == 4 && add_gpt_type(fields[1], fields[2], fields[3])) {
+			continue;
+		}
+		if (strcmp(fields[0], "mbr") == 0 && count == 3) {
+			char * end;
+			unsigned long type = strtoul(fields[1], &end, 16);
+			if (*fields[1] && *end == 0 && type < 256) {
+				if (mbr_types[type] == 0) mbr_types[type] = add_string(fields[2]);
+				continue;
+			}
+		}
+		fprintf(stderr, "%s:%d: invalid type definition\n", path, number);
+		fclose(fd);
+		return 0;
+	}
+	fclose(fd);
+	return 1;
+}
+
+/**
+* @brief Number of entries of each bucket, used to place the largest buckets first
+*/
+static unsigned int * bucket_sizes = NULL;
+
+/**
+* @brief Orders buckets by decreasing number of entries
+*/
+static int compare_buckets(const void * a, const void * b) {
+	unsigned int x = *(const unsigned int *)a, y = *(const unsigned int *)b;
+	if (bucket_sizes[x] != bucket_sizes[y]) return bucket_sizes[x] < bucket_sizes[y] ? 1 : -1;
+	return x < y ? -1 : (x > y);
+}
+
+/**
+* @brief Builds the perfect hash (hash and displace)
+* @param buckets Displacement of each bucket (output)
+* @param slots Entry of each slot plus one (output)
+* @return 1 if every bucket was placed, 0 otherwise
+*/
+static int build_hash(unsigned int num_buckets, unsigned int num_slots, unsigned int * buckets, unsigned int * slots) {
+	unsigned int * order = (unsigned int *)malloc(num_buckets * sizeof(unsigned int));
+	unsigned int * members = (unsigned int *)malloc((num_entries + 1) * sizeof(unsigned int));
+	unsigned int * positions = (unsigned int *)malloc((num_entries + 1) * sizeof(unsigned int));
+	int ok = 1;
+	bucket_sizes = (unsigned int *)calloc(num_buckets, sizeof(unsigned int));
+	//1. Repartir los GUID en los grupos del primer nivel
+	for (unsigned int i = 0; i < num_entries; i++) {
+		entries[i].bucket = typedb_hash(entries[i].guid, 0) % num_buckets;
+		bucket_sizes[entries[i].bucket]++;
+	}
+	for (unsigned int b = 0; b < num_buckets; b++) order[b] = b;
+	qsort(order, num_buckets, sizeof(unsigned int), compare_buckets);
+	//2. Para cada grupo, del más grande al más pequeño, buscar un desplazamiento sin colisiones
+	for (unsigned int o = 0; o < num_buckets && ok; o++) {
+		unsigned int b = order[o], count = 0, d;
+		if (bucket_sizes[b] == 0) break;
+		for (unsigned int i = 0; i < num_entries; i++) {
+			if (entries[i].bucket == b) members[count++] = i;
+		}
+		for (d = 1; d < MAX_DISPLACEMENT; d++) {
+			unsigned int placed = 0;
+			for (; placed < count; placed++) {
+				unsigned int slot = typedb_hash(entries[members[placed]].guid, d) % num_slots;
+				int used = slots[slot] != 0;
+				for (unsigned int k = 0; k < placed && !used; k++) used = positions[k] == slot;
+				if (used) break;
+				positions[placed] = slot;
+			}
+			if (placed == count) break;
+		}
+		if (d == MAX_DISPLACEMENT) {
+			ok = 0;
+			break;
+		}
+		buckets[b] = d;
+		for (unsigned int k = 0; k < count; k++) slots[positions[k]] = members[k] + 1;
+	}
+	free(order);
+	free(members);
+	free(positions);
+	free(bucket_sizes);
+	return ok;
+}
+
+/**
+* @brief Writes the database as a C source that defines typedb_default
+*/
+static int write_c_source(FILE * out, const unsigned char * db, unsigned int size) {
+	fprintf(out, "/* Generado por mktypedb, no editar */\n\n");
+	fprintf(out, "const unsigned char typedb_default[] __attribute__((aligned(8))) = {");
+	for (unsigned int i = 0; i < size; i++) {
+		fprintf(out, "%s0x%02x,", (i % 16) ? " " : "\n\t", db[i]);
+	}
+	fprintf(out, "\n};\n\nconst unsigned int typedb_default_size = %u;\n", size);
+	return !ferror(out);
+}
+
+int main(int argc, char * argv[]) {
+	int c_source = 0, arg = 1;
+	typedb_header hdr;
+	if (arg < argc && strcmp(argv[arg], "-c") == 0) {
+		c_source = 1;
+		arg++;
+	}
+	if (arg >= argc) {
+		fprintf(stderr, "Usage: %s [-c] OUTPUT [TYPES...]\n", argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	const char * output = argv[arg++];
+
+	//1. La cadena vacía ocupa la posición 0 del pool
+	add_string("");
+
+	//2. Tipos del usuario primero, para que tengan prioridad
+	for (; arg < argc; arg++) {
+		if (!read_types_file(argv[arg])) exit(EXIT_FAILURE);
+	}
+
+	//3. Tipos conocidos
+	for (unsigned int i = 0; i < gpt_partition_types_count; i++) {
+		add_gpt_type(gpt_partition_types[i].guid, gpt_partition_types[i].os, gpt_partition_types[i].description);
+	}
+	for (int i = 0; i < 256; i++) {
+		if (mbr_types[i] == 0) mbr_types[i] = add_string(mbr_partition_types[i]);
+	}
+
+	//4. Construir el hash perfecto: cerca de 4 GUID por grupo y 25% de posiciones libres
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.num_gpt = num_entries;
+	hdr.num_buckets = num_entries / 4 + 1;
+	hdr.num_slots = num_entries + num_entries / 4 + 1;
+	unsigned int * buckets = (unsigned int *)calloc(hdr.num_buckets, sizeof(unsigned int));
+	unsigned int * slots = (unsigned int *)calloc(hdr.num_slots, sizeof(unsigned int));
+	if (!build_hash(hdr.num_buckets, hdr.num_slots, buckets, slots)) {
+		fprintf(stderr, "Unable to build the perfect hash\n");
+		exit(EXIT_FAILURE);
+	}
+
+	//5. Ubicar cada región en el archivo
+	memcpy(hdr.magic, TYPEDB_MAGIC, 8);
+	hdr.version = TYPEDB_VERSION;
+	hdr.buckets_offset = sizeof(typedb_header);
+	hdr.slots_offset = hdr.buckets_offset + hdr.num_buckets * 4;
+	hdr.gpt_offset = hdr.slots_offset + hdr.num_slots * 4;
+	hdr.mbr_offset = hdr.gpt_offset + hdr.num_gpt * sizeof(typedb_gpt_entry);
+	hdr.strings_offset = hdr.mbr_offset + 256 * 4;
+	hdr.strings_size = pool_size;
+	hdr.size = hdr.strings_offset + pool_size;
+
+	unsigned char * db = (unsigned char *)calloc(1, hdr.size);
+	memcpy(db, &hdr, sizeof(hdr));
+	memcpy(db + hdr.buckets_offset, buckets, hdr.num_buckets * 4);
+	memcpy(db + hdr.slots_offset, slots, hdr.num_slots * 4);
+	for (unsigned int i = 0; i < num_entries; i++) {
+		typedb_gpt_entry e;
+		memcpy(e.guid, entries[i].guid, 16);
+		e.os = entries[i].os;
+		e.description = entries[i].description;
+		e.guid_str = entries[i].guid_str;
+		memcpy(db + hdr.gpt_offset + i * sizeof(typedb_gpt_entry), &e, sizeof(e));
+	}
+	memcpy(db + hdr.mbr_offset, mbr_types, sizeof(mbr_types));
+	memcpy(db + hdr.strings_offset, pool, pool_size);
+
+	//6. Escribir la base de datos
+	FILE * out = fopen(output, c_source ? "w" : "wb");
+	if (out == NULL) {
+		fprintf(stderr, "Unable to create %s\n", output);
+		exit(EXIT_FAILURE);
+	}
+	int ok = c_source ? write_c_source(out, db, hdr.size) : fwrite(db, 1, hdr.size, out) == hdr.size;
+	if (fclose(out) != 0 || !ok) {
+		fprintf(stderr, "Unable to write %s\n", output);
+		remove(output);
+		exit(EXIT_FAILURE);
+	}
+	free(db);
+	free(buckets);
+	free(slots);
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,298 @@
+/**
+ * @file repair.c
+ * @brief Implementación de la reparación de tablas GPT a partir de la copia válida
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "repair.h"
+#include "gpt.h"
+#include "disk.h"
+#include "crc32.h"
+
+/**
+* @brief Copy of a GPT (header and entry array) read from the disk
+*/
+typedef struct {
+	unsigned long long lba; /*!< LBA where the header was read */
+	gpt_header hdr; /*!< Header */
+	char * array; /*!< Entry array, NULL if it was not read */
+	int header_ok; /*!< 1 if the header is valid, whatever the state of the entry array */
+	int valid; /*!< 1 if the header and the entry array are valid */
+} gpt_copy;
+
+/**
+* @brief Reads and validates the copy of a GPT whose header is at lba
+*/
+static void load_copy(char * disk, unsigned long long lba, gpt_copy * copy) {
+	memset(copy, 0, sizeof(gpt_copy));
+	copy->lba = lba;
+	//1. Encabezado: firma, CRC32, ubicación y límites del arreglo
+	if (read_lba_sector(disk, lba, (char *)&copy->hdr) == 0 || !is_valid_gpt_header(&copy->hdr) ||
+			!gpt_header_crc_ok(&copy->hdr) || copy->hdr.my_lba != lba || !gpt_entries_within_limits(&copy->hdr)) {
+		return;
+	}
+	copy->header_ok = 1;
+	//2. Arreglo de descriptores y su CRC32
+	unsigned long long sectors = gpt_array_sectors(&copy->hdr);
+	copy->array = (char *)malloc(sectors * SECTOR_SIZE);
+	if (copy->array == NULL || read_lba_sectors(disk, copy->hdr.partition_entry_lba, sectors, copy->array) == 0) {
+		return;
+	}
+	size_t size = (size_t)copy->hdr.num_partition_entries * copy->hdr.size_partition_entry;
+	copy->valid = crc32(0, copy->array, size) == copy->hdr.partition_entry_array_crc32;
+}
+
+/**
+* @brief Prints a header field that changes
+* @return 1 if the field changes, 0 otherwise
+*/
+static int print_field(const char * name, unsigned long long before, unsigned long long after) {
+	if (before != after) {
+		printf("  %-28s %llu -> %llu\n", name, before, after);
+	}
+	return before != after;
+}
+
+/**
+* @brief Prints the header fields that differ between the disk and the rebuilt copy
+*/
+static void print_header_diff(gpt_header * before, gpt_header * after) {
+	//La firma se muestra en hexadecimal: en decimal no es legible
+	int changed = before->signature != after->signature;
+	if (changed) {
+		printf("  %-28s 0x%016llx -> 0x%016llx\n", "signature", before->signature, after->signature);
+	}
+	changed += print_field("my_lba", before->my_lba, after->my_lba);
+	changed += print_field("alternate_lba", before->alternate_lba, after->alternate_lba);
+	changed += print_field("first_usable_lba", before->first_usable_lba, after->first_usable_lba);
+	changed += print_field("last_usable_lba", before->last_usable_lba, after->last_usable_lba);
+	changed += print_field("partition_entry_lba", before->partition_entry_lba, after->partition_entry_lba);
+	changed += print_field("num_partition_entries", before->num_partition_entries, after->num_partition_entries);
+	changed += print_field("size_partition_entry", before->size_partition_entry, after->size_partition_entry);
+	changed += print_field("header_crc32", before->header_crc32, after->header_crc32);
+	changed += print_field("partition_entry_array_crc32", before->partition_entry_array_crc32, after->partition_entry_array_crc32);
+	if (changed == 0) {
+		printf("  other header bytes (GUID, revision or reserved area)\n");
+	}
+}
+
+/**
+* @brief Physical block size of a disk, in sectors
+*/
+static unsigned int block_sectors(char * disk) {
+	int fd = open(disk, O_RDONLY);
+	if (fd < 0) return 1;
+	unsigned int size = disk_block_size(fd);
+	close(fd);
+	return size / SECTOR_SIZE;
+}
+
+/**
+* @brief Marks for writing every sector of the physical blocks that have a sector that differs
+* @param differ 1 for each sector of the range that differs, the range starts on a block boundary
+* @param dirty 1 for each sector of the range that must be written (output)
+* @return Number of sectors to write
+*/
+static unsigned long long mark_blocks(char * differ, char * dirty, unsigned long long count, unsigned int block) {
+	unsigned long long total = 0;
+	for (unsigned long long b = 0; b < count; b += block) {
+		unsigned long long n = (count - b < block) ? count - b : block;
+		char changed = memchr(differ + b, 1, n) != NULL;
+		memset(dirty + b, changed, n);
+		total += changed ? n : 0;
+	}
+	return total;
+}
+
+/**
+* @brief Writes the runs of marked sectors with aligned buffers and one fsync
+* @param want Contents that the range must have
+* @param dirty 1 for each sector of the range that must be written (whole physical blocks)
+* @return 1 on success, 0 on failure
+*/
+static int write_runs(char * disk, unsigned long long start, unsigned long long count, char * want, char * dirty) {
+	void * bounce = NULL;
+	int direct = 1;
+	int fd = open(disk, O_WRONLY | O_DIRECT);
+	if (fd < 0) {
+		//Algunos sistemas de archivos no admiten O_DIRECT: se usa la escritura normal
+		direct = 0;
+		fd = open(disk, O_WRONLY);
+	}
+	if (fd < 0 || posix_memalign(&bounce, REPAIR_ALIGN, count * SECTOR_SIZE) != 0) {
+		if (fd >= 0) close(fd);
+		return 0;
+	}
+	int ok = 1;
+	for (unsigned long long i = 0; i < count && ok; ) {
+		if (!dirty[i]) {
+			i++;
+			continue;
+		}
+		//1. Bloques consecutivos marcados se escriben en una sola escritura
+		unsigned long long run = 1;
+		while (i + run < count && dirty[i + run]) run++;
+		size_t size = run * SECTOR_SIZE;
+		off_t offset = (start + i) * SECTOR_SIZE;
+		memcpy(bounce, want + i * SECTOR_SIZE, size);
+		ssize_t written = pwrite(fd, bounce, size, offset);
+		if (written < 0 && errno == EINVAL && direct) {
+			//El dispositivo rechazó la alineación de O_DIRECT: reintentar sin él
+			close(fd);
+			direct = 0;
+			fd = open(disk, O_WRONLY);
+			written = (fd >= 0) ? pwrite(fd, bounce, size, offset) : -1;
+		}
+		ok = written == (ssize_t)size;
+		i += run;
+	}
+	//2. Un solo fsync al final, después de todas las escrituras
+	if (fd >= 0) {
+		ok = (fsync(fd) == 0) && ok;
+		ok = (close(fd) == 0) && ok;
+	}
+	free(bounce);
+	return ok;
+}
+
+int repair_gpt(char * disk, int dry_run) {
+	mbr boot_record;
+	gpt_copy primary, backup;
+	int status = EXIT_FAILURE;
+	unsigned long long sectors = disk_size_sectors(disk);
+
+	if (read_lba_sector(disk, 0, (char *)&boot_record) == 0 || sectors < 3) {
+		fprintf(stderr, "%s: unable to read disk\n", disk);
+		return EXIT_FAILURE;
+	}
+	if (is_mbr(&boot_record)) {
+		fprintf(stderr, "%s: not a GPT disk\n", disk);
+		return EXIT_FAILURE;
+	}
+	//1. Leer ambas copias; la de respaldo se busca donde indica el encabezado primario si este es
+	//válido (aunque su arreglo no lo sea), y si no está ahí, en el último sector (disco ampliado)
+	load_copy(disk, 1, &primary);
+	if (primary.valid && primary.hdr.alternate_lba >= sectors) {
+		fprintf(stderr, "%s: backup header LBA %llu is beyond the end of the disk\n", disk, primary.hdr.alternate_lba);
+		free(primary.array);
+		return EXIT_FAILURE;
+	}
+	unsigned long long backup_lba = (primary.header_ok && primary.hdr.alternate_lba < sectors) ? primary.hdr.alternate_lba : sectors - 1;
+	load_copy(disk, backup_lba, &backup);
+	if (!primary.valid && !backup.valid && backup_lba != sectors - 1) {
+		free(backup.array);
+		load_copy(disk, sectors - 1, &backup);
+	}
+	if (primary.valid && backup.valid) {
+		printf("%s: primary and backup GPT are valid\n", disk);
+		free(primary.array);
+		free(backup.array);
+		return EXIT_SUCCESS;
+	}
+	if (!primary.valid && !backup.valid) {
+		fprintf(stderr, "%s: primary and backup GPT are damaged\n", disk);
+		free(primary.array);
+		free(backup.array);
+		return EXIT_FAILURE;
+	}
+
+	//2. Reconstruir la copia dañada a partir de la válida
+	gpt_copy * good = primary.valid ? &primary : &backup;
+	gpt_header hdr = good->hdr;
+	unsigned long long array_sectors = gpt_array_sectors(&hdr);
+	if (primary.valid) {
+		hdr.my_lba = primary.hdr.alternate_lba;
+		hdr.alternate_lba = 1;
+		hdr.partition_entry_lba = hdr.my_lba - array_sectors;
+	} else {
+		hdr.my_lba = 1;
+		hdr.alternate_lba = backup.lba;
+		hdr.partition_entry_lba = 2;
+	}
+	//2.1 El arreglo reconstruido no puede ocupar el espacio de las particiones
+	if ((primary.valid && (hdr.my_lba <= array_sectors || hdr.partition_entry_lba <= hdr.last_usable_lba)) ||
+			(!primary.valid && hdr.partition_entry_lba + array_sectors > hdr.first_usable_lba)) {
+		fprintf(stderr, "%s: the rebuilt entry array would overlap the usable LBAs\n", disk);
+		free(primary.array);
+		free(backup.array);
+		return EXIT_FAILURE;
+	}
+	size_t array_size = (size_t)hdr.num_partition_entries * hdr.size_partition_entry;
+	hdr.partition_entry_array_crc32 = crc32(0, good->array, array_size);
+	hdr.header_crc32 = 0;
+	hdr.header_crc32 = crc32(0, &hdr, hdr.header_size);
+
+	//3. La copia ocupa un rango contiguo: encabezado y arreglo (primaria) o arreglo y encabezado (respaldo),
+	//ampliado a bloques físicos completos; el relleno conserva el contenido actual del disco
+	unsigned int block = block_sectors(disk);
+	unsigned long long copy_start = primary.valid ? hdr.partition_entry_lba : hdr.my_lba;
+	unsigned long long start = copy_start / block * block;
+	unsigned long long end = (copy_start + array_sectors + 1 + block - 1) / block * block;
+	if (end > sectors) end = sectors;
+	unsigned long long count = end - start;
+	unsigned long long header_index = hdr.my_lba - start;
+	char * want = (char *)malloc(count * SECTOR_SIZE);
+	char * have = (char *)malloc(count * SECTOR_SIZE);
+	char * differ = (char *)calloc(count, 1);
+	char * dirty = (char *)calloc(count, 1);
+	if (want == NULL || have == NULL || differ == NULL || dirty == NULL || read_lba_sectors(disk, start, count, have) == 0) {
+		fprintf(stderr, "%s: unable to read LBAs %llu-%llu\n", disk, start, start + count - 1);
+		goto out;
+	}
+	memcpy(want, have, count * SECTOR_SIZE);
+	memcpy(want + header_index * SECTOR_SIZE, &hdr, SECTOR_SIZE);
+	memcpy(want + (hdr.partition_entry_lba - start) * SECTOR_SIZE, good->array, array_sectors * SECTOR_SIZE);
+
+	//4. Comparar sector por sector con el contenido actual; se escriben los bloques físicos con algún cambio
+	unsigned long long changed = 0;
+	for (unsigned long long i = 0; i < count; i++) {
+		differ[i] = memcmp(want + i * SECTOR_SIZE, have + i * SECTOR_SIZE, SECTOR_SIZE) != 0;
+		changed += differ[i];
+	}
+	unsigned long long written = mark_blocks(differ, dirty, count, block);
+	printf("%s: %s GPT damaged, rebuilding it from the %s GPT\n", disk,
+		primary.valid ? "backup" : "primary", primary.valid ? "primary" : "backup");
+	if (differ[header_index]) {
+		printf("  header at LBA %llu:\n", hdr.my_lba);
+		print_header_diff((gpt_header *)(have + header_index * SECTOR_SIZE), &hdr);
+	}
+	for (unsigned long long i = 0; i < count; ) {
+		if (!dirty[i]) {
+			i++;
+			continue;
+		}
+		unsigned long long run = 1;
+		while (i + run < count && dirty[i + run]) run++;
+		printf("  %s LBA %llu-%llu (%llu sectors)\n", dry_run ? "would write" : "write", start + i, start + i + run - 1, run);
+		i += run;
+	}
+
+	//5. Escribir solo los sectores distintos
+	if (dry_run || changed == 0) {
+		printf("%s: %llu of %llu sectors differ%s\n", disk, changed, array_sectors + 1, dry_run ? " (dry run)" : "");
+		status = EXIT_SUCCESS;
+	} else if (write_runs(disk, start, count, want, dirty)) {
+		printf("%s: %llu sectors differ, %llu sectors written\n", disk, changed, written);
+		status = EXIT_SUCCESS;
+	} else {
+		fprintf(stderr, "%s: unable to write the rebuilt GPT\n", disk);
+	}
+out:
+	free(want);
+	free(have);
+	free(differ);
+	free(dirty);
+	free(primary.array);
+	free(backup.array);
+	return status;
+}
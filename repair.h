@@ -0,0 +1,32 @@
+/**
+ * @file repair.h
+ * @brief Reparación de la copia primaria o de respaldo de una tabla GPT
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef REPAIR_H
+#define REPAIR_H
+
+/** @brief Alignment of the buffers written by the repair, in bytes */
+#define REPAIR_ALIGN 4096
+
+/**
+* @brief Rebuilds the damaged copy of a GPT from the valid one
+*
+* A copy is valid if its header has the GPT signature, a correct CRC32 and
+* its own LBA in my_lba, and its entry array is within limits with a correct
+* CRC32. The damaged copy is rebuilt from the valid one with my_lba,
+* alternate_lba and partition_entry_lba set for its location, and both CRCs
+* recomputed. Only the physical blocks that have a sector that differs from
+* the disk are written, whole and with aligned buffers (O_DIRECT when the
+* device allows it), followed by one fsync.
+* @param disk Disk filename
+* @param dry_run 1 to print the differences without writing
+* @return EXIT_SUCCESS if the GPT is valid or was repaired, EXIT_FAILURE otherwise
+*/
+int repair_gpt(char * disk, int dry_run);
+
+#endif
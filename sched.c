@@ -0,0 +1,277 @@
+/**
+ * @file sched.c
+ * @brief Implementación del planificador de lecturas por controlador
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/sysmacros.h>
+#include "sched.h"
+#include "disk.h"
+
+unsigned int sched_depth = SCHED_CONTROLLER_DEPTH;
+
+/**
+* @brief Queue shared by the disks of a controller
+*/
+typedef struct {
+	char key[PATH_MAX]; /*!< sysfs path that identifies the queue */
+	unsigned int limit; /*!< Reads allowed in flight */
+	unsigned int in_flight; /*!< Reads in flight */
+	unsigned int taken; /*!< Disks taken by a thread whose task has not returned */
+} sched_queue;
+
+/**
+* @brief State of a scan
+*/
+typedef struct {
+	char ** disks; /*!< Disk filenames */
+	int n; /*!< Number of disks */
+	sched_task task; /*!< Task run for each disk */
+	void * arg; /*!< User argument */
+	sched_queue * queues; /*!< Controller queues */
+	int num_queues; /*!< Number of queues */
+	int * controller; /*!< Controller queue of each disk */
+	char * started; /*!< 1 for the disks already taken by a thread */
+	pthread_mutex_t lock; /*!< Protects the queues and started */
+	pthread_cond_t released; /*!< Signaled when a read finishes */
+} sched_state;
+
+/** @brief Scan in progress, used by the read hooks */
+static sched_state * current_scan = NULL;
+
+/** @brief Disk being scanned by this thread, -1 outside a task */
+static __thread int current_disk = -1;
+
+int parse_sched_depth(char * str, unsigned int * depth) {
+	char * end;
+	long value = strtol(str, &end, 10);
+	if (end == str || *end != 0 || value <= 0 || value > UINT_MAX) return 0;
+	*depth = value;
+	return 1;
+}
+
+/**
+* @brief Finds a queue by key, adding it if it does not exist
+* @return Index of the queue
+*/
+static int find_queue(sched_state * state, const char * key, unsigned int limit) {
+	for (int i = 0; i < state->num_queues; i++) {
+		if (strcmp(state->queues[i].key, key) == 0) return i;
+	}
+	sched_queue * queue = &state->queues[state->num_queues];
+	snprintf(queue->key, sizeof(queue->key), "%s", key);
+	queue->limit = limit;
+	queue->in_flight = 0;
+	queue->taken = 0;
+	return state->num_queues++;
+}
+
+/**
+* @brief Checks if a path component is a PCI address (dddd:bb:dd.f)
+*/
+static int is_pci_address(const char * name, int len) {
+	unsigned int domain, bus, dev, fn;
+	char tail;
+	char buf[32];
+	if (len <= 0 || len >= (int)sizeof(buf)) return 0;
+	memcpy(buf, name, len);
+	buf[len] = 0;
+	return sscanf(buf, "%x:%x:%x.%x%c", &domain, &bus, &dev, &fn, &tail) == 4;
+}
+
+/**
+* @brief Finds the controller queue of a disk from sysfs
+*/
+static void assign_queue(sched_state * state, int i) {
+	struct stat st;
+	char link[64], path[PATH_MAX], attr[PATH_MAX + 32], controller[PATH_MAX];
+
+	//1. Los archivos de imagen comparten el controlador del dispositivo que los contiene
+	if (stat(state->disks[i], &st) != 0) {
+		state->controller[i] = find_queue(state, "unknown", sched_depth);
+		return;
+	}
+	dev_t dev = S_ISBLK(st.st_mode) ? st.st_rdev : st.st_dev;
+	snprintf(link, sizeof(link), "/sys/dev/block/%u:%u", major(dev), minor(dev));
+	if (realpath(link, path) == NULL) {
+		state->controller[i] = find_queue(state, "unknown", sched_depth);
+		return;
+	}
+	//2. Una partición usa el controlador del disco que la contiene
+	snprintf(attr, sizeof(attr), "%s/partition", path);
+	if (access(attr, F_OK) == 0) {
+		char * slash = strrchr(path, '/');
+		if (slash != NULL) *slash = 0;
+	}
+	//3. Controlador: la última función PCI de la ruta (los puertos AHCI son hosts SCSI de una misma función)
+	controller[0] = 0;
+	for (char * p = path; *p; ) {
+		char * end = strchr(p + 1, '/');
+		int len = (end != NULL ? end : p + strlen(p)) - (p + 1);
+		if (is_pci_address(p + 1, len)) {
+			snprintf(controller, sizeof(controller), "%.*s", (int)(p + 1 + len - path), path);
+		}
+		if (end == NULL) break;
+		p = end;
+	}
+	if (controller[0] == 0) {
+		//Dispositivos virtuales (loop, dm, md): un controlador por clase
+		snprintf(controller, sizeof(controller), "%s", path);
+		char * slash = strrchr(controller, '/');
+		if (slash != NULL) *slash = 0;
+	}
+	state->controller[i] = find_queue(state, controller, sched_depth);
+}
+
+/**
+* @brief Waits for a free slot of the controller of this thread (disk_read_begin hook)
+*/
+static void sched_read_begin(char * disk) {
+	sched_state * state = current_scan;
+	if (state == NULL || current_disk < 0) return;
+	sched_queue * controller = &state->queues[state->controller[current_disk]];
+	pthread_mutex_lock(&state->lock);
+	while (controller->in_flight >= controller->limit) {
+		pthread_cond_wait(&state->released, &state->lock);
+	}
+	controller->in_flight++;
+	pthread_mutex_unlock(&state->lock);
+}
+
+/**
+* @brief Releases the slot taken by sched_read_begin (disk_read_end hook)
+*/
+static void sched_read_end(char * disk) {
+	sched_state * state = current_scan;
+	if (state == NULL || current_disk < 0) return;
+	pthread_mutex_lock(&state->lock);
+	state->queues[state->controller[current_disk]].in_flight--;
+	pthread_cond_broadcast(&state->released);
+	pthread_mutex_unlock(&state->lock);
+}
+
+/**
+* @brief Takes the pending disk whose controller has the fewest disks taken for its limit
+*
+* Disks taken but not yet reading count too, otherwise every thread that
+* starts before the first read takes a disk of the same controller.
+* @return Index of the disk, -1 if every disk was taken
+*/
+static int next_disk(sched_state * state) {
+	int best = -1;
+	double best_load = 0;
+	pthread_mutex_lock(&state->lock);
+	for (int i = 0; i < state->n; i++) {
+		if (state->started[i]) continue;
+		sched_queue * controller = &state->queues[state->controller[i]];
+		double load = (double)controller->taken / controller->limit;
+		if (best < 0 || load < best_load) {
+			best = i;
+			best_load = load;
+			if (load == 0) break;
+		}
+	}
+	if (best >= 0) {
+		state->started[best] = 1;
+		state->queues[state->controller[best]].taken++;
+	}
+	pthread_mutex_unlock(&state->lock);
+	return best;
+}
+
+/**
+* @brief Returns to its controller the disk taken by next_disk
+*/
+static void finish_disk(sched_state * state, int i) {
+	pthread_mutex_lock(&state->lock);
+	state->queues[state->controller[i]].taken--;
+	pthread_mutex_unlock(&state->lock);
+}
+
+/**
+* @brief Thread that runs the task of the pending disks
+*/
+static void * sched_worker(void * arg) {
+	sched_state * state = (sched_state *)arg;
+	int i;
+	while ((i = next_disk(state)) >= 0) {
+		current_disk = i;
+		state->task(state->disks[i], i, state->arg);
+		current_disk = -1;
+		finish_disk(state, i);
+	}
+	return NULL;
+}
+
+void sched_scan(char ** disks, int n, int threads, sched_task task, void * arg) {
+	sched_state state;
+	pthread_t * ids;
+	int started = 0;
+	unsigned long long slots = 0;
+
+	if (n <= 0) return;
+	memset(&state, 0, sizeof(state));
+	state.disks = disks;
+	state.n = n;
+	state.task = task;
+	state.arg = arg;
+	state.queues = (sched_queue *)calloc(n, sizeof(sched_queue));
+	state.controller = (int *)calloc(n, sizeof(int));
+	state.started = (char *)calloc(n, 1);
+	if (state.queues == NULL || state.controller == NULL || state.started == NULL) {
+		//Sin memoria para el planificador, los discos se escanean en orden
+		for (int i = 0; i < n; i++) task(disks[i], i, arg);
+		free(state.queues);
+		free(state.controller);
+		free(state.started);
+		return;
+	}
+	//1. Topología de cada disco, antes de cualquier lectura
+	for (int i = 0; i < n; i++) {
+		assign_queue(&state, i);
+	}
+	//2. Por defecto, un hilo por cada lectura que admiten los controladores
+	if (threads <= 0) {
+		for (int q = 0; q < state.num_queues; q++) {
+			slots += state.queues[q].limit;
+		}
+		threads = (slots < (unsigned long long)n) ? slots : n;
+	}
+	if (threads > n) threads = n;
+	pthread_mutex_init(&state.lock, NULL);
+	pthread_cond_init(&state.released, NULL);
+	current_scan = &state;
+	disk_read_begin = sched_read_begin;
+	disk_read_end = sched_read_end;
+	//3. Los hilos toman los discos pendientes hasta terminar
+	ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+	if (ids != NULL) {
+		for (; started < threads; started++) {
+			if (pthread_create(&ids[started], NULL, sched_worker, &state) != 0) break;
+		}
+	}
+	if (started == 0) sched_worker(&state);
+	for (int i = 0; i < started; i++) {
+		pthread_join(ids[i], NULL);
+	}
+	disk_read_begin = NULL;
+	disk_read_end = NULL;
+	current_scan = NULL;
+	free(ids);
+	pthread_mutex_destroy(&state.lock);
+	pthread_cond_destroy(&state.released);
+	free(state.queues);
+	free(state.controller);
+	free(state.started);
+}
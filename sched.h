@@ -0,0 +1,51 @@
+/**
+ * @file sched.h
+ * @brief Planificador de lecturas para escaneos de muchos discos, por controlador
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef SCHED_H
+#define SCHED_H
+
+/** @brief Default reads in flight on a controller (HBA, NVMe controller) */
+#define SCHED_CONTROLLER_DEPTH 32
+
+/** @brief Reads in flight allowed on each controller by sched_scan (SCHED_CONTROLLER_DEPTH by default) */
+extern unsigned int sched_depth;
+
+/**
+* @brief Task run for each disk of a scan
+* @param disk Disk filename
+* @param index Index of the disk in the scan
+* @param arg User argument
+*/
+typedef void (*sched_task)(char * disk, int index, void * arg);
+
+/**
+* @brief Parses the reads in flight allowed on each controller
+* @param str Number of reads
+* @param depth Depth to update
+* @return 1 on success, 0 if the value is not a positive number
+*/
+int parse_sched_depth(char * str, unsigned int * depth);
+
+/**
+* @brief Runs a task for each disk, spreading the reads among controllers
+*
+* The controller of each disk (the PCI function of its HBA or NVMe
+* controller) is read from sysfs. Every sector read made by a task through
+* read_lba_sectors() waits for a free slot of its controller, and idle threads
+* take the pending disk whose controller has the fewest disks in progress for
+* its limit, so every controller is kept busy without exceeding sched_depth.
+* @param disks Disk filenames
+* @param n Number of disks
+* @param threads Number of threads (0: as many as the controller slots, up to n)
+* @param task Task run for each disk
+* @param arg User argument passed to the task
+*/
+void sched_scan(char ** disks, int n, int threads, sched_task task, void * arg);
+
+#endif
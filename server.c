@@ -0,0 +1,598 @@
+/**
+ * @file server.c
+ * @brief Implementaciones del servidor local de consultas de particiones
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <linux/netlink.h>
+#include "server.h"
+#include "layout.h"
+#include "disk.h"
+
+/** @brief Set by SIGINT/SIGTERM to stop the server */
+static volatile sig_atomic_t server_stop = 0;
+
+/** @brief Index used by the qsort comparators */
+static server_index * sort_index;
+
+/**
+* @brief Client connection
+*/
+typedef struct {
+	int fd; /*!< Socket */
+	size_t len; /*!< Bytes pending in line */
+	char line[SERVER_LINE_LEN]; /*!< Partial request line */
+	char * out; /*!< Answers not yet written to the socket */
+	size_t out_len; /*!< Bytes in out */
+	size_t out_sent; /*!< Bytes of out already written */
+} server_client;
+
+/**
+* @brief State used to add the GPT entries of a disk to the index
+*/
+typedef struct {
+	server_index * index; /*!< Index */
+	unsigned int disk; /*!< Disk being read */
+} server_loader;
+
+static void handle_signal(int sig) {
+	server_stop = 1;
+}
+
+/**
+* @brief Appends a record to the index
+* @return Pointer to the new record, NULL if there is no memory
+*/
+static server_partition * add_record(server_index * index) {
+	if (index->num_records == index->capacity) {
+		unsigned int capacity = (index->capacity == 0) ? 64 : index->capacity * 2;
+		server_partition * ptr = (server_partition *)realloc(index->records, capacity * sizeof(server_partition));
+		if (ptr == NULL) return NULL;
+		index->records = ptr;
+		index->capacity = capacity;
+	}
+	server_partition * rec = &index->records[index->num_records++];
+	memset(rec, 0, sizeof(server_partition));
+	return rec;
+}
+
+/**
+* @brief Adds a non-null GPT descriptor to the index (gpt_entry_callback)
+*/
+static int load_gpt_entry(gpt_partition_descriptor * desc, unsigned int number, void * arg) {
+	server_loader * loader = (server_loader *)arg;
+	if (is_null_descriptor(desc)) return 1;
+	server_partition * rec = add_record(loader->index);
+	if (rec == NULL) return 0;
+	memcpy(rec->type_guid, desc->partition_type_guid, 16);
+	memcpy(rec->partition_guid, desc->unique_partition_guid, 16);
+	rec->starting_lba = desc->starting_lba;
+	rec->ending_lba = desc->ending_lba;
+	rec->attributes = desc->attributes;
+	rec->disk = loader->disk;
+	rec->number = number + 1;
+	char * name = gpt_decode_partition_name((char *)desc->partition_name);
+	strncpy(rec->name, name, sizeof(rec->name) - 1);
+	free(name);
+	return 1;
+}
+
+/**
+* @brief Reads the partition table of a disk and appends its records to the index
+*/
+static void load_disk(server_index * index, unsigned int d) {
+	server_disk * disk = &index->disks[d];
+	mbr boot_record;
+	gpt_header hdr;
+	struct stat st;
+
+	disk->scheme = 0;
+	disk->stale = 0;
+	memset(&disk->disk_guid, 0, sizeof(guid));
+	if (stat(disk->path, &st) == 0 && S_ISREG(st.st_mode)) {
+		disk->mtime = st.st_mtime;
+		disk->size = st.st_size;
+	}
+	if (read_lba_sector(disk->path, 0, (char *)&boot_record) == 0) {
+		return;
+	}
+	if (is_mbr(&boot_record)) {
+		disk->scheme = LAYOUT_SCHEME_MBR;
+		for (int i = 0; i < 4; i++) {
+			mbr_partition_descriptor * desc = &boot_record.partition_table[i];
+			if (desc->partition_type == MBR_TYPE_UNUSED) continue;
+			server_partition * rec = add_record(index);
+			if (rec == NULL) return;
+			rec->type_guid[0] = desc->partition_type;
+			rec->starting_lba = desc->starting_sector_lba;
+			rec->ending_lba = (unsigned long long)desc->starting_sector_lba + desc->sectors_in_partition - 1;
+			rec->attributes = desc->boot_flag;
+			rec->disk = d;
+			rec->number = i + 1;
+		}
+		return;
+	}
+	if (read_lba_sector(disk->path, 1, (char *)&hdr) == 0 || !is_valid_gpt_header(&hdr)) {
+		return;
+	}
+	unsigned int first = index->num_records;
+	server_loader loader = {index, d};
+	if (gpt_read_entries(disk->path, &hdr, load_gpt_entry, &loader) != GPT_ENTRIES_OK) {
+		//Un arreglo dañado no se publica a medias
+		index->num_records = first;
+		return;
+	}
+	disk->scheme = LAYOUT_SCHEME_GPT;
+	disk->disk_guid = hdr.disk_guid;
+}
+
+static int compare_by_type(const void * a, const void * b) {
+	return memcmp(sort_index->records[*(const unsigned int *)a].type_guid,
+		sort_index->records[*(const unsigned int *)b].type_guid, 16);
+}
+
+static int compare_by_partition(const void * a, const void * b) {
+	return memcmp(sort_index->records[*(const unsigned int *)a].partition_guid,
+		sort_index->records[*(const unsigned int *)b].partition_guid, 16);
+}
+
+static int compare_by_disk(const void * a, const void * b) {
+	return memcmp(&sort_index->disks[sort_index->records[*(const unsigned int *)a].disk].disk_guid,
+		&sort_index->disks[sort_index->records[*(const unsigned int *)b].disk].disk_guid, sizeof(guid));
+}
+
+/**
+* @brief Reads again the stale disks, keeping the records of the others, and rebuilds the sorted indices
+*/
+static void refresh_index(server_index * index) {
+	struct stat st;
+	int stale = 0;
+	//1. Las imágenes que cambiaron de fecha o tamaño también se marcan como obsoletas
+	for (unsigned int d = 0; d < index->num_disks; d++) {
+		server_disk * disk = &index->disks[d];
+		if (!disk->stale && stat(disk->path, &st) == 0 && S_ISREG(st.st_mode) &&
+				(st.st_mtime != disk->mtime || st.st_size != disk->size)) {
+			disk->stale = 1;
+		}
+		stale |= disk->stale;
+	}
+	if (!stale && index->by_type != NULL) return;
+	//2. Compactar los registros de los discos vigentes
+	unsigned int kept = 0;
+	for (unsigned int r = 0; r < index->num_records; r++) {
+		if (!index->disks[index->records[r].disk].stale) {
+			index->records[kept++] = index->records[r];
+		}
+	}
+	index->num_records = kept;
+	//3. Leer los discos obsoletos
+	for (unsigned int d = 0; d < index->num_disks; d++) {
+		if (index->disks[d].stale) load_disk(index, d);
+	}
+	//4. Reconstruir los índices ordenados
+	free(index->by_type);
+	free(index->by_partition);
+	free(index->by_disk);
+	size_t size = (index->num_records > 0 ? index->num_records : 1) * sizeof(unsigned int);
+	index->by_type = (unsigned int *)malloc(size);
+	index->by_partition = (unsigned int *)malloc(size);
+	index->by_disk = (unsigned int *)malloc(size);
+	if (index->by_type == NULL || index->by_partition == NULL || index->by_disk == NULL) {
+		index->num_records = 0;
+		return;
+	}
+	for (unsigned int r = 0; r < index->num_records; r++) {
+		index->by_type[r] = index->by_partition[r] = index->by_disk[r] = r;
+	}
+	sort_index = index;
+	qsort(index->by_type, index->num_records, sizeof(unsigned int), compare_by_type);
+	qsort(index->by_partition, index->num_records, sizeof(unsigned int), compare_by_partition);
+	qsort(index->by_disk, index->num_records, sizeof(unsigned int), compare_by_disk);
+}
+
+/**
+* @brief Key of a record for each sorted index
+*/
+static const void * record_key(server_index * index, unsigned int * sorted, unsigned int r) {
+	server_partition * rec = &index->records[r];
+	if (sorted == index->by_type) return rec->type_guid;
+	if (sorted == index->by_partition) return rec->partition_guid;
+	return &index->disks[rec->disk].disk_guid;
+}
+
+/**
+* @brief Finds the range of records whose key equals key in a sorted index
+* @return Position of the first match; *count receives the number of matches
+*/
+static unsigned int find_range(server_index * index, unsigned int * sorted, const void * key, unsigned int * count) {
+	unsigned int lo = 0, hi = index->num_records;
+	while (lo < hi) {
+		unsigned int mid = lo + (hi - lo) / 2;
+		if (memcmp(record_key(index, sorted, sorted[mid]), key, 16) < 0) lo = mid + 1;
+		else hi = mid;
+	}
+	unsigned int end = lo;
+	while (end < index->num_records && memcmp(record_key(index, sorted, sorted[end]), key, 16) == 0) end++;
+	*count = end - lo;
+	return lo;
+}
+
+/**
+* @brief Appends formatted text to a response buffer
+*/
+static void append(char ** buf, size_t * len, size_t * cap, const char * fmt, ...) {
+	va_list ap;
+	int n;
+	if (*buf == NULL) return;
+	for (;;) {
+		va_start(ap, fmt);
+		n = vsnprintf(*buf + *len, *cap - *len, fmt, ap);
+		va_end(ap);
+		if (n < 0) return;
+		if (*len + n < *cap) break;
+		char * ptr = (char *)realloc(*buf, *cap * 2 + n);
+		if (ptr == NULL) {
+			free(*buf);
+			*buf = NULL;
+			return;
+		}
+		*buf = ptr;
+		*cap = *cap * 2 + n;
+	}
+	*len += n;
+}
+
+/**
+* @brief Formats a partition record as a response line
+*/
+static void append_record(char ** buf, size_t * len, size_t * cap, server_index * index, server_partition * rec) {
+	char * part = guid_to_str((guid *)rec->partition_guid);
+	char * type = guid_to_str((guid *)rec->type_guid);
+	append(buf, len, cap, "%s %u %s %s %llu %llu %llu %s\n", index->disks[rec->disk].path, rec->number, part, type,
+		rec->starting_lba, rec->ending_lba, (rec->ending_lba - rec->starting_lba + 1) * SECTOR_SIZE,
+		rec->name[0] ? rec->name : "-");
+	free(part);
+	free(type);
+}
+
+/**
+* @brief Answers a request line
+* @return New response buffer (must be released by the caller)
+*/
+static char * answer(server_index * index, char * line, size_t * len) {
+	char command[16], arg[64];
+	size_t cap = 1024;
+	char * body = (char *)malloc(cap);
+	size_t body_len = 0;
+	unsigned int lines = 0;
+	guid key;
+
+	if (body == NULL) return NULL;
+	body[0] = 0;
+	int fields = sscanf(line, "%15s %63s", command, arg);
+	if (fields >= 1 && strcasecmp(command, "RESCAN") == 0) {
+		for (unsigned int d = 0; d < index->num_disks; d++) index->disks[d].stale = 1;
+	}
+	refresh_index(index);
+	if (fields >= 1 && strcasecmp(command, "DISKS") == 0) {
+		for (unsigned int d = 0; d < index->num_disks; d++) {
+			unsigned int count = 0;
+			for (unsigned int r = 0; r < index->num_records; r++) count += index->records[r].disk == d;
+			char * g = guid_to_str(&index->disks[d].disk_guid);
+			append(&body, &body_len, &cap, "%s %s %s %u\n", index->disks[d].path,
+				index->disks[d].scheme == LAYOUT_SCHEME_GPT ? "gpt" : index->disks[d].scheme == LAYOUT_SCHEME_MBR ? "mbr" : "unknown",
+				g, count);
+			free(g);
+			lines++;
+		}
+	} else if (fields == 2 && (strcasecmp(command, "TYPE") == 0 || strcasecmp(command, "PART") == 0 || strcasecmp(command, "DISK") == 0)) {
+		unsigned int * sorted = index->by_disk;
+		int ok;
+		if (strcasecmp(command, "TYPE") == 0) {
+			sorted = index->by_type;
+			ok = gpt_type_from_name(arg, &key);
+		} else {
+			if (strcasecmp(command, "PART") == 0) sorted = index->by_partition;
+			ok = str_to_guid(arg, &key);
+		}
+		if (!ok) {
+			free(body);
+			body = (char *)malloc(64);
+			if (body != NULL) *len = snprintf(body, 64, "ERR invalid GUID\n");
+			return body;
+		}
+		unsigned int count;
+		unsigned int first = find_range(index, sorted, &key, &count);
+		for (unsigned int i = 0; i < count; i++) {
+			append_record(&body, &body_len, &cap, index, &index->records[sorted[first + i]]);
+		}
+		lines = count;
+	} else if (fields < 1 || strcasecmp(command, "RESCAN") != 0) {
+		free(body);
+		body = (char *)malloc(64);
+		if (body != NULL) *len = snprintf(body, 64, "ERR unknown command\n");
+		return body;
+	}
+	if (body == NULL) return NULL;
+	//Encabezado de la respuesta: cantidad de líneas que siguen
+	char header[32];
+	int header_len = snprintf(header, sizeof(header), "OK %u\n", lines);
+	char * response = (char *)malloc(header_len + body_len + 1);
+	if (response != NULL) {
+		memcpy(response, header, header_len);
+		memcpy(response + header_len, body, body_len + 1);
+		*len = header_len + body_len;
+	}
+	free(body);
+	return response;
+}
+
+/**
+* @brief Appends an answer to the output pending for a client
+* @return 1 on success, 0 if out of memory
+*/
+static int queue_output(server_client * client, const char * buf, size_t len) {
+	char * out = (char *)realloc(client->out, client->out_len + len);
+	if (out == NULL) return 0;
+	memcpy(out + client->out_len, buf, len);
+	client->out = out;
+	client->out_len += len;
+	return 1;
+}
+
+/**
+* @brief Writes the pending output of a client until the socket would block
+* @return 1 to keep the connection, 0 to close it
+*/
+static int flush_client(server_client * client) {
+	while (client->out_sent < client->out_len) {
+		ssize_t n = write(client->fd, client->out + client->out_sent, client->out_len - client->out_sent);
+		if (n < 0 && errno == EINTR) continue;
+		if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 1;
+		if (n <= 0) return 0;
+		client->out_sent += n;
+	}
+	free(client->out);
+	client->out = NULL;
+	client->out_len = 0;
+	client->out_sent = 0;
+	return 1;
+}
+
+/**
+* @brief Processes the data received from a client
+*
+* The answers are queued and written without blocking; the rest is written
+* by flush_client when the socket accepts more data.
+* @return 1 to keep the connection, 0 to close it
+*/
+static int serve_client(server_index * index, server_client * client) {
+	ssize_t n = read(client->fd, client->line + client->len, sizeof(client->line) - 1 - client->len);
+	if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) return 1;
+	if (n <= 0) return 0;
+	client->len += n;
+	client->line[client->len] = 0;
+	char * nl;
+	while ((nl = strchr(client->line, '\n')) != NULL) {
+		*nl = 0;
+		size_t len = 0;
+		char * response = answer(index, client->line, &len);
+		if (response == NULL || !queue_output(client, response, len)) {
+			free(response);
+			return 0;
+		}
+		free(response);
+		client->len -= (nl + 1) - client->line;
+		memmove(client->line, nl + 1, client->len + 1);
+	}
+	//Una línea que no cabe en el buffer no es una petición válida
+	return client->len < sizeof(client->line) - 1 && flush_client(client);
+}
+
+/**
+* @brief Checks whether a kernel device name is a disk or one of its partitions
+*
+* Partitions append the number to the disk name (sda1), or p and the number
+* when the disk name ends in a digit (nvme0n1p1, mmcblk0p1).
+* @return 1 if devname is name or a partition of name, 0 otherwise
+*/
+static int same_disk(const char * devname, const char * name) {
+	size_t len = strlen(name);
+	if (len == 0 || strncmp(devname, name, len) != 0) return 0;
+	const char * suffix = devname + len;
+	if (*suffix == '\0') return 1;
+	//1. Separador de la partición cuando el nombre del disco termina en dígito
+	if (isdigit((unsigned char)name[len - 1])) {
+		if (*suffix != 'p') return 0;
+		suffix++;
+	}
+	//2. Número de la partición
+	if (*suffix == '\0') return 0;
+	for (; *suffix != '\0'; suffix++) {
+		if (!isdigit((unsigned char)*suffix)) return 0;
+	}
+	return 1;
+}
+
+/**
+* @brief Marks as stale the disks named in a kernel uevent of the block subsystem
+*/
+static void handle_uevent(server_index * index, char * buf, ssize_t len) {
+	char * devname = NULL;
+	int block = 0;
+	for (char * ptr = buf; ptr < buf + len; ptr += strlen(ptr) + 1) {
+		if (strncmp(ptr, "DEVNAME=", 8) == 0) devname = ptr + 8;
+		if (strcmp(ptr, "SUBSYSTEM=block") == 0) block = 1;
+	}
+	if (!block || devname == NULL) return;
+	//Un evento sobre una partición (sda1) también invalida el disco (sda)
+	for (unsigned int d = 0; d < index->num_disks; d++) {
+		char * name = index->disks[d].devname;
+		if (name != NULL && same_disk(devname, name)) {
+			index->disks[d].stale = 1;
+		}
+	}
+}
+
+/**
+* @brief Opens a socket that receives the kernel uevents
+* @return Socket, or -1 if uevents are not available
+*/
+static int open_uevent_socket() {
+	struct sockaddr_nl addr;
+	int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+	if (fd < 0) return -1;
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = 1;
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+/**
+* @brief Kernel name of a block device (sda for /dev/sda), NULL for image files
+*/
+static char * device_name(char * path) {
+	struct stat st;
+	char * real;
+	if (stat(path, &st) != 0 || !S_ISBLK(st.st_mode)) return NULL;
+	real = realpath(path, NULL);
+	if (real == NULL) return NULL;
+	char * base = strrchr(real, '/');
+	char * name = strdup(base != NULL ? base + 1 : real);
+	free(real);
+	return name;
+}
+
+int run_server(char * socket_path, char ** disks, int n) {
+	server_index index;
+	server_client clients[SERVER_MAX_CLIENTS];
+	struct pollfd fds[SERVER_MAX_CLIENTS + 2];
+	struct sockaddr_un addr;
+	int num_clients = 0;
+	int listen_fd, uevent_fd;
+	char uevent[4096];
+
+	//1. Crear el índice residente con todos los discos
+	memset(&index, 0, sizeof(index));
+	index.disks = (server_disk *)calloc(n, sizeof(server_disk));
+	if (index.disks == NULL) return EXIT_FAILURE;
+	index.num_disks = n;
+	for (int d = 0; d < n; d++) {
+		index.disks[d].path = disks[d];
+		index.disks[d].devname = device_name(disks[d]);
+		index.disks[d].stale = 1;
+	}
+	refresh_index(&index);
+
+	//2. Abrir el socket Unix y el socket de eventos del kernel
+	if (strlen(socket_path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Socket path too long\n");
+		return EXIT_FAILURE;
+	}
+	//Solo se reemplaza un socket anterior; cualquier otro archivo en la ruta se conserva
+	struct stat st;
+	if (lstat(socket_path, &st) == 0) {
+		if (!S_ISSOCK(st.st_mode)) {
+			fprintf(stderr, "%s exists and is not a socket\n", socket_path);
+			return EXIT_FAILURE;
+		}
+		unlink(socket_path);
+	}
+	listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, socket_path);
+	if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 16) != 0) {
+		fprintf(stderr, "Unable to listen on %s\n", socket_path);
+		return EXIT_FAILURE;
+	}
+	uevent_fd = open_uevent_socket();
+	if (uevent_fd < 0) {
+		fprintf(stderr, "Warning: device events not available, only image files are revalidated\n");
+	}
+	signal(SIGINT, handle_signal);
+	signal(SIGTERM, handle_signal);
+	signal(SIGPIPE, SIG_IGN);
+
+	//3. Atender peticiones hasta recibir una señal de terminación
+	while (!server_stop) {
+		int nfds = 0;
+		fds[nfds].fd = listen_fd;
+		fds[nfds++].events = POLLIN;
+		fds[nfds].fd = uevent_fd;
+		fds[nfds++].events = POLLIN;
+		//Un cliente con respuestas pendientes no envía más peticiones hasta recibirlas
+		for (int c = 0; c < num_clients; c++) {
+			fds[nfds].fd = clients[c].fd;
+			fds[nfds++].events = (clients[c].out_len > 0) ? POLLOUT : POLLIN;
+		}
+		if (poll(fds, nfds, -1) < 0) {
+			if (errno == EINTR) continue;
+			break;
+		}
+		if (fds[1].revents & POLLIN) {
+			ssize_t len = recv(uevent_fd, uevent, sizeof(uevent) - 1, 0);
+			if (len > 0) {
+				uevent[len] = 0;
+				handle_uevent(&index, uevent, len);
+			}
+		}
+		//Recorrer los clientes de atrás hacia adelante para poder retirar los que cierran
+		for (int c = num_clients - 1; c >= 0; c--) {
+			if (fds[c + 2].revents == 0) continue;
+			int keep = (clients[c].out_len > 0) ? flush_client(&clients[c]) : serve_client(&index, &clients[c]);
+			if (!keep) {
+				close(clients[c].fd);
+				free(clients[c].out);
+				clients[c] = clients[--num_clients];
+			}
+		}
+		if (fds[0].revents & POLLIN) {
+			int fd = accept(listen_fd, NULL, NULL);
+			if (fd >= 0 && num_clients < SERVER_MAX_CLIENTS && fcntl(fd, F_SETFL, O_NONBLOCK) == 0) {
+				memset(&clients[num_clients], 0, sizeof(server_client));
+				clients[num_clients].fd = fd;
+				num_clients++;
+			} else if (fd >= 0) {
+				close(fd);
+			}
+		}
+	}
+
+	//4. Liberar los recursos
+	for (int c = 0; c < num_clients; c++) {
+		close(clients[c].fd);
+		free(clients[c].out);
+	}
+	close(listen_fd);
+	if (uevent_fd >= 0) close(uevent_fd);
+	unlink(socket_path);
+	for (int d = 0; d < n; d++) free(index.disks[d].devname);
+	free(index.disks);
+	free(index.records);
+	free(index.by_type);
+	free(index.by_partition);
+	free(index.by_disk);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file server.h
+ * @brief Servidor local de consultas de particiones sobre un socket Unix
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <time.h>
+#include "gpt.h"
+
+/** @brief Maximum number of simultaneous clients */
+#define SERVER_MAX_CLIENTS 64
+
+/** @brief Maximum length of a request line */
+#define SERVER_LINE_LEN 256
+
+/**
+* @brief Partition record kept in memory by the server
+*/
+typedef struct {
+	unsigned char type_guid[16]; /*!< Type GUID (GPT) or type byte in type_guid[0] (MBR) */
+	unsigned char partition_guid[16]; /*!< Unique partition GUID (zero for MBR) */
+	unsigned long long starting_lba; /*!< Starting LBA */
+	unsigned long long ending_lba; /*!< Ending LBA */
+	unsigned long long attributes; /*!< GPT attributes or MBR boot flag */
+	unsigned int disk; /*!< Index of the disk in the server */
+	unsigned int number; /*!< Partition number (1-based) */
+	char name[37]; /*!< Decoded partition name */
+} server_partition;
+
+/**
+* @brief Disk known by the server
+*/
+typedef struct {
+	char * path; /*!< Disk filename */
+	char * devname; /*!< Kernel device name (sda, nvme0n1, ...) used to match uevents */
+	int scheme; /*!< LAYOUT_SCHEME_MBR, LAYOUT_SCHEME_GPT or 0 if it could not be read */
+	guid disk_guid; /*!< Disk GUID (zero for MBR) */
+	time_t mtime; /*!< Modification time of image files when they were read */
+	long long size; /*!< Size of image files when they were read */
+	int stale; /*!< 1 if the disk must be read again before answering */
+} server_disk;
+
+/**
+* @brief Resident partition index
+*
+* Records are stored contiguously, grouped by disk. by_type, by_partition and
+* by_disk are record indices sorted by type GUID, partition GUID and disk GUID.
+*/
+typedef struct {
+	server_disk * disks; /*!< Disks */
+	unsigned int num_disks; /*!< Number of disks */
+	server_partition * records; /*!< Partition records */
+	unsigned int num_records; /*!< Number of records */
+	unsigned int capacity; /*!< Capacity of records */
+	unsigned int * by_type; /*!< Records sorted by type GUID */
+	unsigned int * by_partition; /*!< Records sorted by partition GUID */
+	unsigned int * by_disk; /*!< Records sorted by disk GUID */
+} server_index;
+
+/**
+* @brief Runs the query server until SIGINT or SIGTERM
+*
+* Line protocol, one request per line. Each answer starts with "OK n"
+* followed by n lines, or with "ERR message".
+* @code
+* DISKS                 path scheme disk-guid partitions
+* DISK <GUID>           partitions of a disk
+* PART <GUID>           partition with the given unique GUID
+* TYPE <alias|GUID>     partitions of a type (esp, linux, swap, ...)
+* RESCAN                forget the cached tables
+* @endcode
+* Partition lines: path number partition-guid type-guid start end size name
+* @param socket_path Path of the Unix domain socket
+* @param disks Disk filenames
+* @param n Number of disks
+* @return Exit status
+*/
+int run_server(char * socket_path, char ** disks, int n);
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file sha256.c
+ * @brief Implementación de SHA-256 (FIPS 180-4)
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <string.h>
+#include "sha256.h"
+
+/** @brief Round constants */
+static const unsigned int sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/**
+* @brief Processes a 64-byte block
+*/
+static void sha256_block(sha256_ctx * ctx, const unsigned char * block) {
+	unsigned int w[64];
+	unsigned int a, b, c, d, e, f, g, h;
+	for (int i = 0; i < 16; i++) {
+		w[i] = ((unsigned int)block[i * 4] << 24) | ((unsigned int)block[i * 4 + 1] << 16) |
+			((unsigned int)block[i * 4 + 2] << 8) | block[i * 4 + 3];
+	}
+	for (int i = 16; i < 64; i++) {
+		unsigned int s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		unsigned int s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+	a = ctx->state[0]; b = ctx->state[1]; c = ctx->state[2]; d = ctx->state[3];
+	e = ctx->state[4]; f = ctx->state[5]; g = ctx->state[6]; h = ctx->state[7];
+	for (int i = 0; i < 64; i++) {
+		unsigned int t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+		unsigned int t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+	ctx->state[0] += a; ctx->state[1] += b; ctx->state[2] += c; ctx->state[3] += d;
+	ctx->state[4] += e; ctx->state[5] += f; ctx->state[6] += g; ctx->state[7] += h;
+}
+
+void sha256_init(sha256_ctx * ctx) {
+	static const unsigned int initial[8] = {
+		0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+	};
+	memcpy(ctx->state, initial, sizeof(initial));
+	ctx->length = 0;
+	ctx->used = 0;
+}
+
+void sha256_update(sha256_ctx * ctx, const void * buf, size_t size) {
+	const unsigned char * ptr = (const unsigned char *)buf;
+	ctx->length += size;
+	//1. Completar el bloque pendiente
+	if (ctx->used > 0) {
+		size_t n = 64 - ctx->used;
+		if (n > size) n = size;
+		memcpy(ctx->block + ctx->used, ptr, n);
+		ctx->used += n;
+		ptr += n;
+		size -= n;
+		if (ctx->used < 64) return;
+		sha256_block(ctx, ctx->block);
+		ctx->used = 0;
+	}
+	//2. Procesar los bloques completos directamente desde el buffer
+	while (size >= 64) {
+		sha256_block(ctx, ptr);
+		ptr += 64;
+		size -= 64;
+	}
+	//3. Guardar el resto para la siguiente llamada
+	memcpy(ctx->block, ptr, size);
+	ctx->used = size;
+}
+
+void sha256_final(sha256_ctx * ctx, unsigned char digest[SHA256_DIGEST_SIZE]) {
+	unsigned long long bits = ctx->length * 8;
+	unsigned char pad[72];
+	size_t pad_len = (ctx->used < 56) ? 56 - ctx->used : 120 - ctx->used;
+	memset(pad, 0, sizeof(pad));
+	pad[0] = 0x80;
+	for (int i = 0; i < 8; i++) {
+		pad[pad_len + i] = (bits >> (56 - i * 8)) & 0xff;
+	}
+	sha256_update(ctx, pad, pad_len + 8);
+	for (int i = 0; i < 8; i++) {
+		digest[i * 4] = ctx->state[i] >> 24;
+		digest[i * 4 + 1] = ctx->state[i] >> 16;
+		digest[i * 4 + 2] = ctx->state[i] >> 8;
+		digest[i * 4 + 3] = ctx->state[i];
+	}
+}
@@ -0,0 +1,49 @@
+/**
+ * @file sha256.h
+ * @brief Cálculo de SHA-256 (FIPS 180-4)
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <stddef.h>
+
+/** @brief Size of a SHA-256 digest in bytes */
+#define SHA256_DIGEST_SIZE 32
+
+/**
+* @brief SHA-256 context
+*/
+typedef struct {
+	unsigned int state[8]; /*!< Hash state */
+	unsigned long long length; /*!< Bytes processed */
+	unsigned char block[64]; /*!< Pending block */
+	size_t used; /*!< Bytes used in block */
+} sha256_ctx;
+
+/**
+* @brief Initializes a SHA-256 context
+* @param ctx Context
+*/
+void sha256_init(sha256_ctx * ctx);
+
+/**
+* @brief Adds a buffer to a SHA-256 context
+* @param ctx Context
+* @param buf Buffer
+* @param size Buffer size
+*/
+void sha256_update(sha256_ctx * ctx, const void * buf, size_t size);
+
+/**
+* @brief Finishes the computation and writes the digest
+* @param ctx Context
+* @param digest Digest
+*/
+void sha256_final(sha256_ctx * ctx, unsigned char digest[SHA256_DIGEST_SIZE]);
+
+#endif
@@ -0,0 +1,515 @@
+/**
+ * @file snapshot.c
+ * @brief Implementación de las instantáneas columnares y de sus consultas agregadas
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+#include "gpt.h"
+#include "disk.h"
+#include "sched.h"
+#include "typedb.h"
+
+/** @brief Alignment of the regions of a snapshot */
+#define SNAPSHOT_ALIGN 8
+
+/**
+* @brief GPT entries read from a disk
+*/
+typedef struct {
+	int ok; /*!< 1 if the entry array was read and its CRC32 is correct */
+	int bad_crc; /*!< 1 if the entry array was read but its CRC32 does not match */
+	gpt_header hdr; /*!< Primary GPT header */
+	unsigned long long sectors; /*!< Size of the disk in sectors */
+	gpt_partition_descriptor * descs; /*!< Non-null entries */
+	unsigned int * numbers; /*!< Partition number of each entry */
+	unsigned int count; /*!< Number of entries */
+	unsigned int capacity; /*!< Capacity of descs and numbers */
+} snapshot_disk;
+
+/**
+* @brief Disks read by the scheduler
+*/
+typedef struct {
+	snapshot_disk * results; /*!< Entries read from each disk */
+	const int * source; /*!< Disk read for each disk, NULL to read all of them */
+} snapshot_scan;
+
+/**
+* @brief String heap being built
+*/
+typedef struct {
+	char * buf; /*!< Strings */
+	unsigned int size; /*!< Bytes used */
+	unsigned int capacity; /*!< Bytes allocated */
+} snapshot_heap;
+
+/**
+* @brief Keeps a copy of each non-null entry (gpt_entry_callback)
+*/
+static int add_descriptor(gpt_partition_descriptor * desc, unsigned int index, void * arg) {
+	snapshot_disk * disk = (snapshot_disk *)arg;
+	if (is_null_descriptor(desc)) return 1;
+	if (disk->count == disk->capacity) {
+		unsigned int capacity = disk->capacity ? disk->capacity * 2 : 16;
+		//Si una reserva falla, los arreglos anteriores siguen en disk y se liberan al final
+		gpt_partition_descriptor * descs = (gpt_partition_descriptor *)realloc(disk->descs, capacity * sizeof(gpt_partition_descriptor));
+		if (descs == NULL) return 0;
+		disk->descs = descs;
+		unsigned int * numbers = (unsigned int *)realloc(disk->numbers, capacity * sizeof(unsigned int));
+		if (numbers == NULL) return 0;
+		disk->numbers = numbers;
+		disk->capacity = capacity;
+	}
+	disk->descs[disk->count] = *desc;
+	disk->numbers[disk->count++] = index + 1;
+	return 1;
+}
+
+/**
+* @brief Reads the GPT entries of a disk (sched_task)
+*/
+static void read_snapshot_disk(char * disk, int index, void * arg) {
+	snapshot_scan * scan = (snapshot_scan *)arg;
+	if (scan->source != NULL && scan->source[index] != index) return;
+	snapshot_disk * result = &scan->results[index];
+	mbr boot_record;
+	if (read_lba_sector(disk, 0, (char *)&boot_record) == 0 || is_mbr(&boot_record)) return;
+	if (read_lba_sector(disk, 1, (char *)&result->hdr) == 0 || !is_valid_gpt_header(&result->hdr)) return;
+	int status = gpt_read_entries(disk, &result->hdr, add_descriptor, result);
+	//Un arreglo con el CRC32 incorrecto no es confiable: el disco se deja por fuera
+	result->ok = status == GPT_ENTRIES_OK;
+	result->bad_crc = status == GPT_ENTRIES_BAD_CRC;
+	result->sectors = disk_size_sectors(disk);
+}
+
+/**
+* @brief Appends a string to the heap
+* @return Offset of the string, 0 for an empty string or if there is no memory
+*/
+static unsigned int heap_add(snapshot_heap * heap, const char * str) {
+	unsigned int len = strlen(str) + 1;
+	if (len == 1) return 0;
+	if (heap->size + len > heap->capacity) {
+		unsigned int capacity = heap->capacity ? heap->capacity * 2 : 4096;
+		while (capacity < heap->size + len) capacity *= 2;
+		char * buf = (char *)realloc(heap->buf, capacity);
+		if (buf == NULL) return 0;
+		heap->buf = buf;
+		heap->capacity = capacity;
+	}
+	memcpy(heap->buf + heap->size, str, len);
+	heap->size += len;
+	return heap->size - len;
+}
+
+/**
+* @brief Rounds an offset up to SNAPSHOT_ALIGN
+*/
+static unsigned long long align(unsigned long long offset) {
+	return (offset + SNAPSHOT_ALIGN - 1) & ~(unsigned long long)(SNAPSHOT_ALIGN - 1);
+}
+
+/**
+* @brief Writes a buffer to a temporary file and renames it over filename
+* @return 1 on success, 0 on failure
+*/
+static int replace_file(char * filename, const char * buf, size_t len) {
+	size_t tmp_len = strlen(filename) + 16;
+	char * tmp = (char *)malloc(tmp_len);
+	int status = 0;
+	if (tmp == NULL) return 0;
+	snprintf(tmp, tmp_len, "%s.%d.tmp", filename, (int)getpid());
+	int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd >= 0) {
+		status = write(fd, buf, len) == (ssize_t)len;
+		status = (close(fd) == 0) && status;
+		if (status && rename(tmp, filename) != 0) status = 0;
+		if (!status) unlink(tmp);
+	}
+	free(tmp);
+	return status;
+}
+
+int write_snapshot(char * filename, char ** disks, int n, const int * source, int threads) {
+	snapshot_header hdr;
+	snapshot_heap heap = {NULL, 0, 0};
+	char host[256];
+	int skipped = 0, failed = 0;
+	unsigned int * device_of = (unsigned int *)calloc(n, sizeof(unsigned int));
+	snapshot_disk * results = (snapshot_disk *)calloc(n, sizeof(snapshot_disk));
+	unsigned char (* types)[16] = (unsigned char (*)[16])malloc(16);
+	if (device_of == NULL || results == NULL || types == NULL) {
+		free(device_of);
+		free(results);
+		free(types);
+		return -1;
+	}
+
+	//1. Leer los arreglos de descriptores de todos los discos
+	snapshot_scan scan = {results, source};
+	sched_scan(disks, n, threads, read_snapshot_disk, &scan);
+	//Cada alias es un dispositivo con las entradas del disco leído en su lugar
+	for (int i = 0; source != NULL && i < n; i++) {
+		if (source[i] != i) results[i] = results[source[i]];
+	}
+
+	//2. Diccionarios: un host, los dispositivos leídos y los GUID de tipo distintos
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, SNAPSHOT_MAGIC, 8);
+	hdr.version = SNAPSHOT_VERSION;
+	heap.buf = (char *)calloc(1, 4096);
+	heap.capacity = (heap.buf != NULL) ? 4096 : 0;
+	heap.size = 1;
+	if (gethostname(host, sizeof(host)) != 0) strcpy(host, "unknown");
+	host[sizeof(host) - 1] = 0;
+	unsigned int host_name = heap_add(&heap, host);
+	hdr.num_hosts = 1;
+	for (int i = 0; i < n; i++) {
+		if (results[i].bad_crc) {
+			fprintf(stderr, "%s: partition entry array CRC32 mismatch, left out\n", disks[i]);
+			skipped++;
+			continue;
+		}
+		if (!results[i].ok) {
+			fprintf(stderr, "Unable to read GPT partition table of %s\n", disks[i]);
+			skipped++;
+			continue;
+		}
+		device_of[i] = hdr.num_devices++;
+		hdr.rows += results[i].count;
+		for (unsigned int r = 0; r < results[i].count; r++) {
+			unsigned int t = 0;
+			while (t < hdr.num_types && memcmp(types[t], results[i].descs[r].partition_type_guid, 16) != 0) t++;
+			if (t == hdr.num_types) {
+				unsigned char (* grown)[16] = (unsigned char (*)[16])realloc(types, (hdr.num_types + 1) * 16);
+				if (grown == NULL) {
+					failed = 1;
+					continue;
+				}
+				types = grown;
+				memcpy(types[hdr.num_types++], results[i].descs[r].partition_type_guid, 16);
+			}
+		}
+	}
+
+	//3. Ubicar cada región: diccionarios, columnas de 4 bytes, columnas de 8 bytes y el heap
+	unsigned long long offset = sizeof(snapshot_header);
+	hdr.hosts_offset = offset; offset = align(offset + hdr.num_hosts * 4ULL);
+	hdr.devices_offset = offset; offset = align(offset + hdr.num_devices * (unsigned long long)sizeof(snapshot_device));
+	hdr.types_offset = offset; offset = align(offset + hdr.num_types * 16ULL);
+	hdr.device_column = offset; offset = align(offset + hdr.rows * 4);
+	hdr.number_column = offset; offset = align(offset + hdr.rows * 4);
+	hdr.type_column = offset; offset = align(offset + hdr.rows * 4);
+	hdr.name_column = offset; offset = align(offset + hdr.rows * 4);
+	hdr.start_column = offset; offset += hdr.rows * 8;
+	hdr.end_column = offset; offset += hdr.rows * 8;
+	hdr.attrs_column = offset; offset += hdr.rows * 8;
+	hdr.heap_offset = offset;
+
+	//4. Llenar las columnas; los nombres se agregan al heap mientras tanto
+	char * buf = (char *)calloc(1, offset);
+	unsigned long long row = 0;
+	if (buf != NULL && !failed) {
+		unsigned int * device_col = (unsigned int *)(buf + hdr.device_column);
+		unsigned int * number_col = (unsigned int *)(buf + hdr.number_column);
+		unsigned int * type_col = (unsigned int *)(buf + hdr.type_column);
+		unsigned int * name_col = (unsigned int *)(buf + hdr.name_column);
+		unsigned long long * start_col = (unsigned long long *)(buf + hdr.start_column);
+		unsigned long long * end_col = (unsigned long long *)(buf + hdr.end_column);
+		unsigned long long * attrs_col = (unsigned long long *)(buf + hdr.attrs_column);
+		snapshot_device * devices = (snapshot_device *)(buf + hdr.devices_offset);
+		memcpy(buf + hdr.hosts_offset, &host_name, 4);
+		memcpy(buf + hdr.types_offset, types, hdr.num_types * 16);
+		for (int i = 0; i < n; i++) {
+			if (!results[i].ok) continue;
+			snapshot_device * device = &devices[device_of[i]];
+			device->host = 0;
+			device->name = heap_add(&heap, disks[i]);
+			memcpy(device->disk_guid, &results[i].hdr.disk_guid, 16);
+			device->sectors = results[i].sectors;
+			for (unsigned int r = 0; r < results[i].count; r++, row++) {
+				gpt_partition_descriptor * desc = &results[i].descs[r];
+				unsigned int t = 0;
+				while (memcmp(types[t], desc->partition_type_guid, 16) != 0) t++;
+				char * name = gpt_decode_partition_name((char *)desc->partition_name);
+				device_col[row] = device_of[i];
+				number_col[row] = results[i].numbers[r];
+				type_col[row] = t;
+				name_col[row] = heap_add(&heap, name);
+				start_col[row] = desc->starting_lba;
+				end_col[row] = desc->ending_lba;
+				attrs_col[row] = desc->attributes;
+				free(name);
+			}
+		}
+	}
+
+	//5. Agregar el heap al final y escribir el archivo completo
+	int status = 0;
+	if (buf != NULL && heap.buf != NULL && row == hdr.rows) {
+		hdr.heap_size = heap.size;
+		hdr.size = offset + heap.size;
+		char * file = (char *)realloc(buf, hdr.size);
+		if (file != NULL) {
+			buf = file;
+			memcpy(buf, &hdr, sizeof(hdr));
+			memcpy(buf + hdr.heap_offset, heap.buf, heap.size);
+			status = replace_file(filename, buf, hdr.size);
+		}
+	}
+	for (int i = 0; i < n; i++) {
+		if (source != NULL && source[i] != i) continue;
+		free(results[i].descs);
+		free(results[i].numbers);
+	}
+	free(results);
+	free(device_of);
+	free(types);
+	free(heap.buf);
+	free(buf);
+	return status ? skipped : -1;
+}
+
+int parse_snapshot_query(const char * name) {
+	if (strcmp(name, "types") == 0) return SNAPSHOT_QUERY_TYPES;
+	if (strcmp(name, "sizes") == 0) return SNAPSHOT_QUERY_SIZES;
+	if (strcmp(name, "summary") == 0) return SNAPSHOT_QUERY_SUMMARY;
+	return 0;
+}
+
+/**
+* @brief Checks that a region of rows x size bytes is inside the snapshot
+*/
+static int region_ok(unsigned long long offset, unsigned long long rows, unsigned long long size, unsigned long long total) {
+	return offset <= total && rows <= (total - offset) / size;
+}
+
+/**
+* @brief Heap offset of the name of a host of a mapped snapshot
+*/
+static unsigned int host_offset(const char * data, unsigned int h) {
+	const snapshot_header * hdr = (const snapshot_header *)data;
+	unsigned int offset;
+	memcpy(&offset, data + hdr->hosts_offset + h * 4ULL, 4);
+	return offset;
+}
+
+/**
+* @brief String at an offset of the heap of a mapped snapshot
+* @return The string, NULL if it does not end inside the heap
+*/
+static const char * heap_string(const char * data, unsigned int offset) {
+	const snapshot_header * hdr = (const snapshot_header *)data;
+	if (offset >= hdr->heap_size) return NULL;
+	const char * str = data + hdr->heap_offset + offset;
+	return (memchr(str, 0, hdr->heap_size - offset) != NULL) ? str : NULL;
+}
+
+/**
+* @brief Checks the header, the bounds of every region, the type column and the host names of a snapshot
+*/
+static int snapshot_valid(const char * data, unsigned long long size) {
+	const snapshot_header * hdr = (const snapshot_header *)data;
+	if (size < sizeof(snapshot_header) || memcmp(hdr->magic, SNAPSHOT_MAGIC, 8) != 0 ||
+			hdr->version != SNAPSHOT_VERSION || hdr->size != size) {
+		return 0;
+	}
+	if (!region_ok(hdr->hosts_offset, hdr->num_hosts, 4, size) ||
+			!region_ok(hdr->devices_offset, hdr->num_devices, sizeof(snapshot_device), size) ||
+			!region_ok(hdr->types_offset, hdr->num_types, 16, size) ||
+			!region_ok(hdr->device_column, hdr->rows, 4, size) || !region_ok(hdr->number_column, hdr->rows, 4, size) ||
+			!region_ok(hdr->type_column, hdr->rows, 4, size) || !region_ok(hdr->name_column, hdr->rows, 4, size) ||
+			!region_ok(hdr->start_column, hdr->rows, 8, size) || !region_ok(hdr->end_column, hdr->rows, 8, size) ||
+			!region_ok(hdr->attrs_column, hdr->rows, 8, size) || !region_ok(hdr->heap_offset, hdr->heap_size, 1, size) ||
+			(hdr->start_column | hdr->end_column | hdr->type_column) % SNAPSHOT_ALIGN != 0) {
+		return 0;
+	}
+	//Los índices de tipo se usan sin verificar en las consultas: se verifican una vez aquí
+	const unsigned int * type_col = (const unsigned int *)(data + hdr->type_column);
+	unsigned int max = 0;
+	for (unsigned long long r = 0; r < hdr->rows; r++) {
+		max = (type_col[r] > max) ? type_col[r] : max;
+	}
+	if (hdr->rows != 0 && max >= hdr->num_types) return 0;
+	//Los nombres de los hosts deben terminar dentro del heap
+	for (unsigned int h = 0; h < hdr->num_hosts; h++) {
+		if (heap_string(data, host_offset(data, h)) == NULL) return 0;
+	}
+	return 1;
+}
+
+/**
+* @brief Aggregate of a type over all the snapshots
+*/
+typedef struct {
+	unsigned char guid[16]; /*!< Type GUID */
+	unsigned long long count; /*!< Number of partitions */
+	unsigned long long sectors; /*!< Total sectors */
+} type_total;
+
+/**
+* @brief Sectors of a row; an entry whose end is before its start has none
+*
+* Written without branches or 64-bit comparisons (the borrow of end - start
+* is taken from its sign bit) so the loops over the columns vectorize.
+*/
+static inline unsigned long long row_sectors(unsigned long long start, unsigned long long end) {
+	unsigned long long diff = end - start;
+	unsigned long long borrow = ((~end & start) | (~(end ^ start) & diff)) >> 63;
+	return (diff + 1) & (borrow - 1);
+}
+
+/**
+* @brief Orders type totals by decreasing number of partitions
+*/
+static int compare_totals(const void * a, const void * b) {
+	const type_total * x = (const type_total *)a, * y = (const type_total *)b;
+	if (x->count != y->count) return x->count < y->count ? 1 : -1;
+	return memcmp(x->guid, y->guid, 16);
+}
+
+int query_snapshots(int query, char ** files, int n) {
+	type_total * totals = NULL;
+	unsigned int num_totals = 0;
+	unsigned long long histogram[64] = {0};
+	char ** hosts = NULL;
+	unsigned int num_hosts = 0;
+	unsigned long long devices = 0, rows = 0, sectors = 0;
+	int status = EXIT_SUCCESS;
+
+	for (int f = 0; f < n; f++) {
+		//1. Mapear la instantánea y verificar sus regiones
+		struct stat st;
+		int fd = open(files[f], O_RDONLY);
+		if (fd < 0 || fstat(fd, &st) != 0 || st.st_size == 0) {
+			fprintf(stderr, "Unable to open snapshot %s\n", files[f]);
+			if (fd >= 0) close(fd);
+			status = EXIT_FAILURE;
+			continue;
+		}
+		char * data = (char *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+		if (data == MAP_FAILED || !snapshot_valid(data, st.st_size)) {
+			fprintf(stderr, "Invalid snapshot %s\n", files[f]);
+			if (data != MAP_FAILED) munmap(data, st.st_size);
+			status = EXIT_FAILURE;
+			continue;
+		}
+		const snapshot_header * hdr = (const snapshot_header *)data;
+		const unsigned int * type_col = (const unsigned int *)(data + hdr->type_column);
+		const unsigned long long * start_col = (const unsigned long long *)(data + hdr->start_column);
+		const unsigned long long * end_col = (const unsigned long long *)(data + hdr->end_column);
+		unsigned long long count = hdr->rows;
+		devices += hdr->num_devices;
+		rows += count;
+
+		//2. Recorrer solo las columnas que necesita la consulta, de forma secuencial
+		if (query == SNAPSHOT_QUERY_TYPES) {
+			unsigned long long * counts = (unsigned long long *)calloc(hdr->num_types + 1, sizeof(unsigned long long));
+			unsigned long long * type_sectors = (unsigned long long *)calloc(hdr->num_types + 1, sizeof(unsigned long long));
+			if (counts == NULL || type_sectors == NULL) {
+				fprintf(stderr, "Out of memory\n");
+				free(counts);
+				free(type_sectors);
+				munmap(data, st.st_size);
+				free(totals);
+				return EXIT_FAILURE;
+			}
+			for (unsigned long long r = 0; r < count; r++) {
+				counts[type_col[r]]++;
+				type_sectors[type_col[r]] += row_sectors(start_col[r], end_col[r]);
+			}
+			//2.1 Combinar con los totales de las demás instantáneas por GUID
+			for (unsigned int t = 0; t < hdr->num_types; t++) {
+				const unsigned char * guid = (const unsigned char *)(data + hdr->types_offset + t * 16);
+				unsigned int g = 0;
+				while (g < num_totals && memcmp(totals[g].guid, guid, 16) != 0) g++;
+				if (g == num_totals) {
+					type_total * grown = (type_total *)realloc(totals, (num_totals + 1) * sizeof(type_total));
+					if (grown == NULL) {
+						fprintf(stderr, "Out of memory\n");
+						free(counts);
+						free(type_sectors);
+						munmap(data, st.st_size);
+						free(totals);
+						return EXIT_FAILURE;
+					}
+					totals = grown;
+					memset(&totals[g], 0, sizeof(type_total));
+					memcpy(totals[g].guid, guid, 16);
+					num_totals++;
+				}
+				totals[g].count += counts[t];
+				totals[g].sectors += type_sectors[t];
+			}
+			free(counts);
+			free(type_sectors);
+		} else if (query == SNAPSHOT_QUERY_SIZES) {
+			for (unsigned long long r = 0; r < count; r++) {
+				unsigned long long bytes = row_sectors(start_col[r], end_col[r]) * SECTOR_SIZE;
+				histogram[63 - __builtin_clzll(bytes | 1)]++;
+			}
+		} else {
+			for (unsigned long long r = 0; r < count; r++) {
+				sectors += row_sectors(start_col[r], end_col[r]);
+			}
+			//2.2 Un host que aparece en varias instantáneas se cuenta una sola vez
+			for (unsigned int h = 0; h < hdr->num_hosts; h++) {
+				const char * host = heap_string(data, host_offset(data, h));
+				unsigned int k = 0;
+				while (k < num_hosts && strcmp(hosts[k], host) != 0) k++;
+				if (k < num_hosts) continue;
+				char ** grown = (char **)realloc(hosts, (num_hosts + 1) * sizeof(char *));
+				if (grown == NULL || (grown[num_hosts] = strdup(host)) == NULL) {
+					fprintf(stderr, "Out of memory\n");
+					if (grown != NULL) hosts = grown;
+					for (k = 0; k < num_hosts; k++) free(hosts[k]);
+					free(hosts);
+					munmap(data, st.st_size);
+					return EXIT_FAILURE;
+				}
+				hosts = grown;
+				num_hosts++;
+			}
+		}
+		munmap(data, st.st_size);
+	}
+
+	//3. Imprimir el resultado
+	if (query == SNAPSHOT_QUERY_TYPES) {
+		qsort(totals, num_totals, sizeof(type_total), compare_totals);
+		printf("partitions\tbytes\ttype\tdescription\n");
+		for (unsigned int g = 0; g < num_totals; g++) {
+			const gpt_partition_type * type = typedb_gpt_type(totals[g].guid);
+			char * guid_str = guid_to_str((guid *)totals[g].guid);
+			printf("%llu\t%llu\t%s\t%s\n", totals[g].count, totals[g].sectors * SECTOR_SIZE, guid_str,
+				type != NULL ? type->description : "Unknown");
+			free(guid_str);
+		}
+	} else if (query == SNAPSHOT_QUERY_SIZES) {
+		printf("from_bytes\tto_bytes\tpartitions\n");
+		for (int b = 0; b < 64; b++) {
+			if (histogram[b] == 0) continue;
+			//El primer intervalo también cuenta las entradas vacías (0 bytes)
+			printf("%llu\t%llu\t%llu\n", (b > 0) ? 1ULL << b : 0, (b < 63) ? (1ULL << (b + 1)) - 1 : ~0ULL, histogram[b]);
+		}
+	} else {
+		printf("hosts\tdevices\tpartitions\tbytes\n");
+		printf("%u\t%llu\t%llu\t%llu\n", num_hosts, devices, rows, sectors * SECTOR_SIZE);
+	}
+	for (unsigned int h = 0; h < num_hosts; h++) free(hosts[h]);
+	free(hosts);
+	free(totals);
+	return status;
+}
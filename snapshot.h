@@ -0,0 +1,102 @@
+/**
+ * @file snapshot.h
+ * @brief Instantáneas columnares de las tablas GPT y consultas agregadas sobre ellas
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/** @brief Magic number of a snapshot */
+#define SNAPSHOT_MAGIC "LPSNAP01"
+
+/** @brief Format version of a snapshot */
+#define SNAPSHOT_VERSION 1
+
+/** @brief Query: partitions and bytes by type GUID */
+#define SNAPSHOT_QUERY_TYPES 1
+
+/** @brief Query: histogram of partition sizes (powers of two) */
+#define SNAPSHOT_QUERY_SIZES 2
+
+/** @brief Query: hosts, devices, partitions and bytes */
+#define SNAPSHOT_QUERY_SUMMARY 3
+
+/**
+* @brief Header of a snapshot
+*
+* A snapshot stores the non-null GPT entries of a set of disks as columns
+* (struct of arrays): row r is a partition, and each column holds one field
+* of every row. Offsets are relative to the beginning of the file and every
+* column is aligned to 8 bytes. Strings are offsets into the string heap,
+* where offset 0 is the empty string.
+*/
+typedef struct {
+	char magic[8]; /*!< SNAPSHOT_MAGIC */
+	unsigned int version; /*!< SNAPSHOT_VERSION */
+	unsigned int heap_size; /*!< Size of the string heap */
+	unsigned long long size; /*!< Size of the snapshot in bytes */
+	unsigned long long rows; /*!< Number of partitions */
+	unsigned int num_hosts; /*!< Entries of the host dictionary */
+	unsigned int num_devices; /*!< Entries of the device dictionary */
+	unsigned int num_types; /*!< Entries of the type GUID dictionary */
+	unsigned int reserved; /*!< Reserved, 0 */
+	unsigned long long hosts_offset; /*!< Host names (num_hosts x 4 bytes, heap offsets) */
+	unsigned long long devices_offset; /*!< Devices (num_devices x snapshot_device) */
+	unsigned long long types_offset; /*!< Type GUIDs in on-disk byte order (num_types x 16 bytes) */
+	unsigned long long device_column; /*!< Device of each row (rows x 4 bytes) */
+	unsigned long long number_column; /*!< Partition number of each row (rows x 4 bytes) */
+	unsigned long long type_column; /*!< Type of each row (rows x 4 bytes) */
+	unsigned long long name_column; /*!< Name of each row (rows x 4 bytes, heap offsets) */
+	unsigned long long start_column; /*!< Starting LBA of each row (rows x 8 bytes) */
+	unsigned long long end_column; /*!< Ending LBA of each row (rows x 8 bytes) */
+	unsigned long long attrs_column; /*!< Attributes of each row (rows x 8 bytes) */
+	unsigned long long heap_offset; /*!< String heap */
+}__attribute__((packed)) snapshot_header;
+
+/**
+* @brief Entry of the device dictionary of a snapshot
+*/
+typedef struct {
+	unsigned int host; /*!< Host of the device */
+	unsigned int name; /*!< Device filename (heap offset) */
+	unsigned char disk_guid[16]; /*!< Disk GUID */
+	unsigned long long sectors; /*!< Size of the device in sectors */
+}__attribute__((packed)) snapshot_device;
+
+/**
+* @brief Reads the GPT entry arrays of the disks and writes them as a snapshot
+*
+* The disks are read in parallel by the scheduler (sched_scan); MBR disks,
+* disks that cannot be read and entry arrays with a wrong CRC32 are reported
+* and left out. The snapshot is written to a temporary file and renamed over
+* filename.
+* @param filename Snapshot filename
+* @param disks Disk filenames
+* @param n Number of disks
+* @param source Disk read for each disk (see alias_sources), NULL to read all of them
+* @param threads Disks read concurrently (0: as many as the controller slots)
+* @return Number of disks left out, -1 if the snapshot could not be written
+*/
+int write_snapshot(char * filename, char ** disks, int n, const int * source, int threads);
+
+/**
+* @brief Parses the name of a query: types, sizes or summary
+* @param name Query name
+* @return SNAPSHOT_QUERY_*, 0 if the name is unknown
+*/
+int parse_snapshot_query(const char * name);
+
+/**
+* @brief Maps snapshots and prints an aggregate over all their rows
+* @param query SNAPSHOT_QUERY_*
+* @param files Snapshot filenames
+* @param n Number of snapshots
+* @return EXIT_SUCCESS, or EXIT_FAILURE if a snapshot is not valid
+*/
+int query_snapshots(int query, char ** files, int n);
+
+#endif
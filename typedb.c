@@ -0,0 +1,146 @@
+/**
+ * @file typedb.c
+ * @brief Implementaciones de la base de datos binaria de tipos de partición
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "typedb.h"
+
+/** @brief Copy of the database embedded at build time (typedb_default.c, absent in mktypedb) */
+extern const unsigned char typedb_default[] __attribute__((weak));
+
+/** @brief Size of typedb_default */
+extern const unsigned int typedb_default_size __attribute__((weak));
+
+char * typedb_path = NULL;
+
+/** @brief Database in use, NULL until the first lookup */
+static const unsigned char * db = NULL;
+
+/** @brief Partition types already resolved, one per GPT entry of the database */
+static gpt_partition_type * resolved = NULL;
+
+unsigned int typedb_hash(const unsigned char guid[16], unsigned int seed) {
+	unsigned int h = 2166136261u ^ (seed * 0x9e3779b9u);
+	for (int i = 0; i < 16; i++) {
+		h ^= guid[i];
+		h *= 16777619u;
+	}
+	//Mezcla final para que todos los bits dependan de la semilla
+	h ^= h >> 15;
+	h *= 0x2c1b3c6du;
+	h ^= h >> 12;
+	return h;
+}
+
+int typedb_valid(const unsigned char * data, size_t size) {
+	const typedb_header * hdr = (const typedb_header *)data;
+	if (size < sizeof(typedb_header) || memcmp(hdr->magic, TYPEDB_MAGIC, 8) != 0 ||
+			hdr->version != TYPEDB_VERSION || hdr->size != size) {
+		return 0;
+	}
+	//Cada región debe quedar dentro del archivo (productos en 64 bits para evitar desbordes)
+	if ((unsigned long long)hdr->buckets_offset + hdr->num_buckets * 4ULL > size ||
+			(unsigned long long)hdr->slots_offset + hdr->num_slots * 4ULL > size ||
+			(unsigned long long)hdr->gpt_offset + hdr->num_gpt * (unsigned long long)sizeof(typedb_gpt_entry) > size ||
+			(unsigned long long)hdr->mbr_offset + 256 * 4ULL > size ||
+			(unsigned long long)hdr->strings_offset + hdr->strings_size > size ||
+			hdr->num_buckets == 0 || hdr->num_slots == 0 || hdr->strings_size == 0 ||
+			data[hdr->strings_offset + hdr->strings_size - 1] != 0) {
+		return 0;
+	}
+	return 1;
+}
+
+/**
+* @brief Maps a database file
+* @return Database contents, NULL if the file does not exist or is not valid
+*/
+static const unsigned char * map_file(const char * path) {
+	struct stat st;
+	void * ptr;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return NULL;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return NULL;
+	}
+	ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (ptr == MAP_FAILED) return NULL;
+	if (!typedb_valid((const unsigned char *)ptr, st.st_size)) {
+		fprintf(stderr, "Invalid partition type database %s\n", path);
+		munmap(ptr, st.st_size);
+		return NULL;
+	}
+	return (const unsigned char *)ptr;
+}
+
+int typedb_load() {
+	const char * env = getenv(TYPEDB_ENV);
+	if (db != NULL) return 1;
+	//Una base de datos pedida explícitamente no se reemplaza por otra
+	if (typedb_path != NULL) {
+		db = map_file(typedb_path);
+		if (db == NULL) {
+			fprintf(stderr, "Unable to load partition type database %s\n", typedb_path);
+			return 0;
+		}
+	}
+	if (db == NULL && env != NULL) db = map_file(env);
+	if (db == NULL) db = map_file(TYPEDB_DEFAULT_PATH);
+	if (db == NULL && &typedb_default_size != NULL && typedb_valid(typedb_default, typedb_default_size)) {
+		db = typedb_default;
+	}
+	if (db == NULL) return 0;
+	resolved = (gpt_partition_type *)calloc(((const typedb_header *)db)->num_gpt, sizeof(gpt_partition_type));
+	return 1;
+}
+
+/**
+* @brief String of the pool at an offset
+*/
+static const char * pool_string(unsigned int offset) {
+	const typedb_header * hdr = (const typedb_header *)db;
+	return (offset < hdr->strings_size) ? (const char *)db + hdr->strings_offset + offset : "";
+}
+
+const gpt_partition_type * typedb_gpt_type(const unsigned char guid[16]) {
+	unsigned int displacement, slot, entry;
+	if (!typedb_load()) return NULL;
+	const typedb_header * hdr = (const typedb_header *)db;
+	//1. Primer nivel: desplazamiento del grupo; segundo nivel: posición única del GUID
+	memcpy(&displacement, db + hdr->buckets_offset + (typedb_hash(guid, 0) % hdr->num_buckets) * 4, 4);
+	slot = typedb_hash(guid, displacement) % hdr->num_slots;
+	memcpy(&entry, db + hdr->slots_offset + slot * 4, 4);
+	if (entry == 0 || entry > hdr->num_gpt) return NULL;
+	//2. El GUID del registro confirma que la clave existe
+	const typedb_gpt_entry * e = (const typedb_gpt_entry *)(db + hdr->gpt_offset) + (entry - 1);
+	if (memcmp(e->guid, guid, 16) != 0) return NULL;
+	if (resolved == NULL) return NULL;
+	gpt_partition_type * type = &resolved[entry - 1];
+	if (type->guid == NULL) {
+		type->os = pool_string(e->os);
+		type->description = pool_string(e->description);
+		type->guid = pool_string(e->guid_str);
+	}
+	return type;
+}
+
+const char * typedb_mbr_type(unsigned char type) {
+	unsigned int offset;
+	if (!typedb_load()) return "Unknown";
+	const typedb_header * hdr = (const typedb_header *)db;
+	memcpy(&offset, db + hdr->mbr_offset + type * 4, 4);
+	return (offset == 0) ? "Unknown" : pool_string(offset);
+}
@@ -0,0 +1,103 @@
+/**
+ * @file typedb.h
+ * @brief Base de datos binaria de tipos de partición, cargada con mmap
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef TYPEDB_H
+#define TYPEDB_H
+
+#include "gpt.h"
+
+/** @brief Magic number of a type database */
+#define TYPEDB_MAGIC "LPTYPEDB"
+
+/** @brief Format version of a type database */
+#define TYPEDB_VERSION 1
+
+/** @brief Default location of the installed type database */
+#define TYPEDB_DEFAULT_PATH "/usr/local/share/listpart/types.db"
+
+/** @brief Environment variable that overrides the database location */
+#define TYPEDB_ENV "LISTPART_TYPES_DB"
+
+/**
+* @brief Header of a type database
+*
+* All offsets are relative to the beginning of the file, and all strings are
+* offsets into the string pool. GPT types are found with a hash-and-displace
+* perfect hash: slot = typedb_hash(guid, buckets[typedb_hash(guid, 0) % num_buckets]) % num_slots.
+*/
+typedef struct {
+	char magic[8]; /*!< TYPEDB_MAGIC */
+	unsigned int version; /*!< TYPEDB_VERSION */
+	unsigned int size; /*!< Size of the database in bytes */
+	unsigned int num_gpt; /*!< Number of GPT types */
+	unsigned int num_buckets; /*!< Number of first-level buckets */
+	unsigned int num_slots; /*!< Number of slots of the perfect hash */
+	unsigned int buckets_offset; /*!< Displacement of each bucket (num_buckets x 4 bytes) */
+	unsigned int slots_offset; /*!< GPT entry of each slot, plus one (0 = empty) (num_slots x 4 bytes) */
+	unsigned int gpt_offset; /*!< GPT entries (num_gpt x typedb_gpt_entry) */
+	unsigned int mbr_offset; /*!< String of each MBR type (256 x 4 bytes) */
+	unsigned int strings_offset; /*!< String pool */
+	unsigned int strings_size; /*!< Size of the string pool */
+}__attribute__((packed)) typedb_header;
+
+/**
+* @brief GPT type stored in a type database
+*/
+typedef struct {
+	unsigned char guid[16]; /*!< Type GUID, in on-disk byte order */
+	unsigned int os; /*!< Operating system (string pool offset) */
+	unsigned int description; /*!< Description (string pool offset) */
+	unsigned int guid_str; /*!< Text GUID (string pool offset) */
+}__attribute__((packed)) typedb_gpt_entry;
+
+/** @brief Database path set with --types-db, NULL to use TYPEDB_ENV or TYPEDB_DEFAULT_PATH */
+extern char * typedb_path;
+
+/**
+* @brief Hash used by the perfect hash of a type database
+* @param guid Type GUID, in on-disk byte order
+* @param seed Seed (bucket displacement)
+* @return Hash value
+*/
+unsigned int typedb_hash(const unsigned char guid[16], unsigned int seed);
+
+/**
+* @brief Checks the header and bounds of a type database
+* @param db Database contents
+* @param size Database size
+* @return 1 if the database is valid, 0 otherwise
+*/
+int typedb_valid(const unsigned char * db, size_t size);
+
+/**
+* @brief Maps the database used by the lookups, if it is not mapped yet
+*
+* typedb_path, when set, is the only database tried; otherwise TYPEDB_ENV,
+* then TYPEDB_DEFAULT_PATH, then the copy embedded at build time.
+* @return 1 if a database is available, 0 otherwise
+*/
+int typedb_load();
+
+/**
+* @brief Finds a GPT partition type in the database
+*
+* The database is mapped on the first call (typedb_load).
+* @param guid Type GUID, in on-disk byte order
+* @return Partition type, NULL if it is not in the database
+*/
+const gpt_partition_type * typedb_gpt_type(const unsigned char guid[16]);
+
+/**
+* @brief Finds the description of a MBR partition type in the database
+* @param type MBR partition type
+* @return Description, "Unknown" if it is not in the database
+*/
+const char * typedb_mbr_type(unsigned char type);
+
+#endif
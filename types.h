@@ -0,0 +1,24 @@
+/**
+ * @file types.h
+ * @brief Tablas de tipos de partición usadas para generar la base de datos de tipos
+ * @author Jhoan David Chacón <jhoanchacon@unicauca.edu.co>
+ * @author Jonathan David Guejia <jonathanguejia@unicauca.edu.co>
+ * @author Erwin Meza Vega <emezav@unicauca.edu.co>
+ * @copyright MIT License
+*/
+
+#ifndef TYPES_H
+#define TYPES_H
+
+#include "gpt.h"
+
+/** @brief Known GPT partition types, terminated by a null entry */
+extern const gpt_partition_type gpt_partition_types[];
+
+/** @brief Number of entries of gpt_partition_types, without the null entry */
+extern const unsigned int gpt_partition_types_count;
+
+/** @brief Description of each MBR partition type */
+extern const char * mbr_partition_types[256];
+
+#endif